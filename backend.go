@@ -0,0 +1,177 @@
+package main
+
+import (
+	"context"
+	"fmt"
+	"math/big"
+	"os"
+	"runtime"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/AlexanderYastrebov/vanity25519"
+)
+
+// backend is a search engine for public keys of a key type.
+type backend struct {
+	name    string
+	keyType *keyType
+	// maxChains is the maximum number of interleaved batch inversion chains.
+	maxChains int
+	// canPipeline tells whether the backend supports pipeline.
+	canPipeline bool
+	// search checks public keys at offsets from the start public key until ctx is done.
+	search func(ctx context.Context, p *searchParams)
+}
+
+// searchParams are parameters of a single search run by a backend.
+type searchParams struct {
+	startPublicKey []byte
+	startOffset    *big.Int
+	batchSize      int
+	// chains is the number of interleaved batch inversion chains.
+	chains int
+	// pipeline enables testing a batch while the next one is computed.
+	pipeline bool
+	// test reports whether public key matches.
+	test func([]byte) bool
+	// found receives matching public key and its offset, both are only valid during the call.
+	found func([]byte, *big.Int)
+	// progress is called with the amount of public keys checked since the previous call,
+	// at least once per batch.
+	progress func(n int)
+}
+
+// backends lists available backends, the first backend of a key type is its default.
+var backends = []*backend{
+	{
+		name:      "vanity25519",
+		keyType:   x25519KeyType,
+		maxChains: 1,
+		search: func(ctx context.Context, p *searchParams) {
+			var n int
+			test := func(publicKey []byte) bool {
+				if n++; n == p.batchSize {
+					p.progress(n)
+					n = 0
+				}
+				return p.test(publicKey)
+			}
+			vanity25519.Search(ctx, p.startPublicKey, p.startOffset, p.batchSize, test, p.found)
+			p.progress(n)
+		},
+	},
+	{
+		name:        "ed25519",
+		keyType:     ed25519KeyType,
+		maxChains:   maxChains,
+		canPipeline: true,
+		search:      ed25519Search,
+	},
+}
+
+// backendWarmup is the duration of backend run before the benchmark,
+// it covers precomputed tables and lets the workers reach steady state.
+const backendWarmup = 100 * time.Millisecond
+
+// backendBenchmark is the duration of backend benchmark run by auto selection.
+const backendBenchmark = 250 * time.Millisecond
+
+// selectBackend returns backend of the job and whether to use pipeline.
+// The "auto" backend benchmarks backends of the key type that support options of the job,
+// with and without pipeline unless the job enables it, and selects the fastest.
+func selectBackend(job Job, kt *keyType, test func([]byte) bool) (*backend, bool, error) {
+	var candidates []*backend
+	for _, b := range backends {
+		if b.keyType != kt {
+			continue
+		}
+		if job.Backend == "" {
+			return b, job.Pipeline, nil
+		}
+		if job.Backend == b.name || job.Backend == "auto" && b.supports(job) {
+			candidates = append(candidates, b)
+		}
+	}
+	switch {
+	case len(candidates) == 0 && job.Backend == "auto":
+		return nil, false, fmt.Errorf("no %s backend supports the job", kt.name)
+	case len(candidates) == 0:
+		return nil, false, fmt.Errorf("unknown %s backend %q", kt.name, job.Backend)
+	case job.Backend != "auto":
+		return candidates[0], job.Pipeline, nil
+	}
+
+	type option struct {
+		backend  *backend
+		pipeline bool
+	}
+	var options []option
+	for _, b := range candidates {
+		if !job.Pipeline {
+			options = append(options, option{b, false})
+		}
+		if b.canPipeline {
+			options = append(options, option{b, true})
+		}
+	}
+	if len(options) == 1 {
+		return options[0].backend, options[0].pipeline, nil
+	}
+
+	var best option
+	var bestRate float64
+	for _, o := range options {
+		rate, err := o.backend.benchmark(job, o.pipeline, runtime.GOMAXPROCS(0), test)
+		if err != nil {
+			return nil, false, err
+		}
+		fmt.Fprintf(os.Stderr, "Backend %s with pipeline %t checks %.0f keys/s\n", o.backend.name, o.pipeline, rate)
+		if rate > bestRate {
+			best, bestRate = o, rate
+		}
+	}
+	fmt.Fprintf(os.Stderr, "Using backend %s with pipeline %t\n", best.backend.name, best.pipeline)
+	return best.backend, best.pipeline, nil
+}
+
+// supports tells whether backend supports options of the job.
+func (b *backend) supports(job Job) bool {
+	return job.Chains <= b.maxChains && (!job.Pipeline || b.canPipeline)
+}
+
+// benchmark returns the rate of public keys checked by specified amount of workers running at once
+// after the warmup.
+func (b *backend) benchmark(job Job, pipeline bool, workers int, test func([]byte) bool) (float64, error) {
+	_, startPublicKey, err := b.keyType.generate()
+	if err != nil {
+		return 0, err
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	defer cancel()
+
+	var checked atomic.Int64
+	var wg sync.WaitGroup
+	for range workers {
+		wg.Go(func() {
+			b.search(ctx, &searchParams{
+				startPublicKey: startPublicKey,
+				startOffset:    randBigInt(),
+				batchSize:      job.BatchSize,
+				chains:         max(job.Chains, 1),
+				pipeline:       pipeline,
+				test:           test,
+				found:          func([]byte, *big.Int) {},
+				progress:       func(n int) { checked.Add(int64(n)) },
+			})
+		})
+	}
+	time.Sleep(backendWarmup)
+	start, startChecked := time.Now(), checked.Load()
+	time.Sleep(backendBenchmark)
+	rate := float64(checked.Load()-startChecked) / time.Since(start).Seconds()
+	cancel()
+	wg.Wait()
+	return rate, nil
+}
@@ -0,0 +1,46 @@
+package main
+
+import "testing"
+
+func TestSelectBackend(t *testing.T) {
+	test := func([]byte) bool { return false }
+	for _, tc := range []struct {
+		job      Job
+		keyType  *keyType
+		want     string
+		pipeline []bool
+	}{
+		{Job{}, x25519KeyType, "vanity25519", []bool{false}},
+		{Job{}, ed25519KeyType, "ed25519", []bool{false}},
+		{Job{Pipeline: true}, ed25519KeyType, "ed25519", []bool{true}},
+		{Job{Backend: "ed25519", Pipeline: true}, ed25519KeyType, "ed25519", []bool{true}},
+		{Job{Backend: "auto", BatchSize: 256}, x25519KeyType, "vanity25519", []bool{false}},
+		{Job{Backend: "auto", BatchSize: 256}, ed25519KeyType, "ed25519", []bool{false, true}},
+		{Job{Backend: "auto", BatchSize: 256, Chains: 2}, ed25519KeyType, "ed25519", []bool{false, true}},
+		{Job{Backend: "auto", BatchSize: 256, Pipeline: true}, ed25519KeyType, "ed25519", []bool{true}},
+		{Job{Backend: "ed25519-pipeline"}, ed25519KeyType, "", nil},
+		{Job{Backend: "vanity25519"}, ed25519KeyType, "", nil},
+		{Job{Backend: "unknown"}, x25519KeyType, "", nil},
+		{Job{Backend: "auto", Chains: 2}, x25519KeyType, "", nil},
+		{Job{Backend: "auto", Pipeline: true}, x25519KeyType, "", nil},
+	} {
+		b, pipeline, err := selectBackend(tc.job, tc.keyType, test)
+		if tc.want == "" {
+			if err == nil {
+				t.Errorf("%+v: expected error, got %s", tc.job, b.name)
+			}
+			continue
+		}
+		if err != nil {
+			t.Errorf("%+v: %v", tc.job, err)
+			continue
+		}
+		found := false
+		for _, p := range tc.pipeline {
+			found = found || pipeline == p
+		}
+		if b.name != tc.want || !found {
+			t.Errorf("%+v: got %s with pipeline %t, want %s with pipeline one of %v", tc.job, b.name, pipeline, tc.want, tc.pipeline)
+		}
+	}
+}
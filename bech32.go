@@ -0,0 +1,68 @@
+package main
+
+import "strings"
+
+// bech32Alphabet lists bech32 symbols in the order of their 5-bit values.
+const bech32Alphabet = "qpzry9x8gf2tvdw0s3jn54khce6mua7l"
+
+// bech32Encode returns bech32 encoding of data with human-readable part hrp
+// as specified by BIP 173, without the 90 characters length limit like age does.
+func bech32Encode(hrp string, data []byte) string {
+	var values []byte
+	acc, n := 0, 0
+	for _, b := range data {
+		acc = acc<<8 | int(b)
+		for n += 8; n >= 5; n -= 5 {
+			values = append(values, byte(acc>>(n-5)&31))
+		}
+	}
+	if n > 0 {
+		values = append(values, byte(acc<<(5-n)&31))
+	}
+
+	var b strings.Builder
+	b.WriteString(hrp)
+	b.WriteByte('1')
+	for _, v := range values {
+		b.WriteByte(bech32Alphabet[v])
+	}
+	for _, v := range bech32Checksum(hrp, values) {
+		b.WriteByte(bech32Alphabet[v])
+	}
+	return b.String()
+}
+
+func bech32Checksum(hrp string, values []byte) []byte {
+	var expanded []byte
+	for i := 0; i < len(hrp); i++ {
+		expanded = append(expanded, hrp[i]>>5)
+	}
+	expanded = append(expanded, 0)
+	for i := 0; i < len(hrp); i++ {
+		expanded = append(expanded, hrp[i]&31)
+	}
+	expanded = append(expanded, values...)
+	expanded = append(expanded, 0, 0, 0, 0, 0, 0)
+
+	mod := bech32Polymod(expanded) ^ 1
+	checksum := make([]byte, 6)
+	for i := range checksum {
+		checksum[i] = byte(mod >> (5 * (5 - i)) & 31)
+	}
+	return checksum
+}
+
+func bech32Polymod(values []byte) uint32 {
+	generator := [5]uint32{0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3}
+	chk := uint32(1)
+	for _, v := range values {
+		top := chk >> 25
+		chk = (chk&0x1ffffff)<<5 ^ uint32(v)
+		for i, g := range generator {
+			if top>>i&1 != 0 {
+				chk ^= g
+			}
+		}
+	}
+	return chk
+}
@@ -0,0 +1,45 @@
+package main
+
+import (
+	"encoding/hex"
+	"testing"
+)
+
+func TestBech32Encode(t *testing.T) {
+	for _, tc := range []struct {
+		hrp  string
+		data string
+		want string
+	}{
+		// BIP 173 test vectors
+		{"a", "", "a12uel5l"},
+		{"abcdef", "00443214c74254b635cf84653a56d7c675be77df", "abcdef1qpzry9x8gf2tvdw0s3jn54khce6mua7lmqqqxw"},
+	} {
+		data, err := hex.DecodeString(tc.data)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if got := bech32Encode(tc.hrp, data); got != tc.want {
+			t.Errorf("bech32Encode(%q, %s) = %s, want %s", tc.hrp, tc.data, got, tc.want)
+		}
+	}
+}
+
+func TestBech32AgeKeys(t *testing.T) {
+	// RFC 7748 X25519 key pair
+	private, _ := hex.DecodeString("77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a")
+	public, err := x25519KeyType.publicKey(private)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if got, want := hex.EncodeToString(public), "8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a"; got != want {
+		t.Fatalf("public key %s, want %s", got, want)
+	}
+
+	if got, want := bech32Encoding.public(public), "age1s5s0qzvfxzn4gayt0hwtg0hhtgxm7wsdycup4a8t5j5ca25mfe4qt4hs7q"; got != want {
+		t.Errorf("recipient %s, want %s", got, want)
+	}
+	if got, want := bech32Encoding.private(private), "AGE-SECRET-KEY-1WURK6ZNNRZJH60QKC9E9RVNXGH05CTU8A0QFJ243WLA628DE9S4QRFH26J"; got != want {
+		t.Errorf("identity %s, want %s", got, want)
+	}
+}
@@ -0,0 +1,203 @@
+package main
+
+import (
+	"cmp"
+	"encoding/json"
+	"fmt"
+	"io"
+	"math/big"
+	"os"
+	"slices"
+	"time"
+)
+
+// Job is a blind search job spec.
+// It carries everything a worker needs to search around a starting public key
+// without knowing the private key.
+type Job struct {
+	ID          string `json:"id,omitempty"`
+	Public      string `json:"public"`
+	Prefix      string `json:"prefix,omitempty"`
+	Regex       string `json:"regex,omitempty"`
+	Expr        string `json:"expr,omitempty"`
+	Mask        string `json:"mask,omitempty"`
+	Targets     string `json:"targets,omitempty"`
+	Encoding    string `json:"encoding,omitempty"`
+	KeyType     string `json:"key_type,omitempty"`
+	IgnoreCase  bool   `json:"ignore_case,omitempty"`
+	Homoglyphs  bool   `json:"homoglyphs,omitempty"`
+	MaxMismatch int    `json:"max_mismatch,omitempty"`
+	Shard       uint64 `json:"shard,omitempty"`
+	BatchSize   int    `json:"batch_size,omitempty"`
+	Chains      int    `json:"chains,omitempty"`
+	Pipeline    bool   `json:"pipeline,omitempty"`
+	Backend     string `json:"backend,omitempty"`
+	Keys        uint64 `json:"keys,omitempty"`
+	Top         int    `json:"top,omitempty"`
+}
+
+// name returns ID of the job, or its starting public key if the job has no ID.
+func (j Job) name() string {
+	switch {
+	case j.ID != "":
+		return fmt.Sprintf("%q", j.ID)
+	case j.Public != "":
+		return j.Public
+	}
+	return "with generated key"
+}
+
+// hasPattern reports whether the job has a pattern other than prefix.
+func (j Job) hasPattern() bool {
+	return j.Regex != "" || j.Expr != "" || j.Mask != "" || j.Targets != ""
+}
+
+// ResultBundle is the result of a blind search job.
+// It is consumed by the add subcommand which verifies every result
+// against the starting private key.
+type ResultBundle struct {
+	Job               Job            `json:"job"`
+	Results           []SearchResult `json:"results"`
+	Best              []SearchResult `json:"best,omitempty"`
+	Attempts          uint64         `json:"attempts"`
+	Duration          float64        `json:"duration"`
+	AttemptsPerSecond float64        `json:"attempts_per_second"`
+}
+
+func newResultBundle(t *searchTask, results []SearchResult, elapsed time.Duration) *ResultBundle {
+	attempts := t.attempts.Load()
+	return &ResultBundle{
+		Job:               t.job,
+		Results:           results,
+		Best:              mergeTopKeys(t.job.Top, t.top),
+		Attempts:          attempts,
+		Duration:          elapsed.Seconds(),
+		AttemptsPerSecond: float64(attempts) / elapsed.Seconds(),
+	}
+}
+
+// OffsetRange is a range of offsets [Start, Start+Count) checked by a worker.
+// Backends check offsets in ascending order from the start offset,
+// the order of vanity25519 is assumed rather than verified.
+type OffsetRange struct {
+	Worker int      `json:"worker"`
+	Start  *big.Int `json:"start"`
+	Count  uint64   `json:"count"`
+}
+
+// CoverageReport describes offset ranges checked by the search.
+// It allows to audit or resume an interrupted search.
+type CoverageReport struct {
+	Attempts          uint64        `json:"attempts"`
+	Duration          float64       `json:"duration"`
+	AttemptsPerSecond float64       `json:"attempts_per_second"`
+	Jobs              []JobCoverage `json:"jobs"`
+}
+
+// JobCoverage describes offset ranges checked for a single job.
+type JobCoverage struct {
+	ID       string        `json:"id,omitempty"`
+	Public   string        `json:"public"`
+	Attempts uint64        `json:"attempts"`
+	Ranges   []OffsetRange `json:"ranges"`
+}
+
+func writeCoverage(name string, tasks []*searchTask, attempts uint64, elapsed time.Duration) error {
+	report := &CoverageReport{
+		Attempts:          attempts,
+		Duration:          elapsed.Seconds(),
+		AttemptsPerSecond: float64(attempts) / elapsed.Seconds(),
+	}
+	for _, t := range tasks {
+		t.mu.Lock()
+		ranges := slices.Clone(t.covered)
+		t.mu.Unlock()
+
+		slices.SortFunc(ranges, func(a, b OffsetRange) int {
+			if c := cmp.Compare(a.Worker, b.Worker); c != 0 {
+				return c
+			}
+			return a.Start.Cmp(b.Start)
+		})
+		report.Jobs = append(report.Jobs, JobCoverage{
+			ID:       t.job.ID,
+			Public:   t.job.Public,
+			Attempts: t.attempts.Load(),
+			Ranges:   ranges,
+		})
+	}
+
+	f, err := os.Create(name)
+	if err != nil {
+		return err
+	}
+	enc := json.NewEncoder(f)
+	enc.SetIndent("", "  ")
+	if err := enc.Encode(report); err != nil {
+		f.Close()
+		return err
+	}
+	return f.Close()
+}
+
+// readJobs decodes a stream of job specs from the named file or stdin if name is "-".
+// Fields missing from a job spec are taken from defaults.
+func readJobs(name string, defaults Job) ([]Job, error) {
+	var jobs []Job
+	err := withInput(name, func(r io.Reader) error {
+		dec := json.NewDecoder(r)
+		for {
+			job := defaults
+			if err := dec.Decode(&job); err == io.EOF {
+				return nil
+			} else if err != nil {
+				return err
+			}
+			jobs = append(jobs, job)
+		}
+	})
+	if err == nil && len(jobs) == 0 {
+		err = fmt.Errorf("no jobs in %s", name)
+	}
+	return jobs, err
+}
+
+// readBundles decodes a stream of result bundles from the named file or stdin if name is "-".
+func readBundles(name string) ([]*ResultBundle, error) {
+	var bundles []*ResultBundle
+	err := withInput(name, func(r io.Reader) error {
+		dec := json.NewDecoder(r)
+		for {
+			bundle := new(ResultBundle)
+			if err := dec.Decode(bundle); err == io.EOF {
+				return nil
+			} else if err != nil {
+				return err
+			}
+			bundles = append(bundles, bundle)
+		}
+	})
+	if err == nil && len(bundles) == 0 {
+		err = fmt.Errorf("no result bundles in %s", name)
+	}
+	return bundles, err
+}
+
+func withInput(name string, f func(io.Reader) error) error {
+	if name == "-" {
+		return f(os.Stdin)
+	}
+	file, err := os.Open(name)
+	if err != nil {
+		return err
+	}
+	defer file.Close()
+	return f(file)
+}
+
+// shardOffset returns random offset within the shard.
+// Shards split offset space into disjoint 2^64 ranges.
+func shardOffset(shard uint64) *big.Int {
+	offset := new(big.Int).Lsh(new(big.Int).SetUint64(shard), 64)
+	return offset.Add(offset, randBigInt())
+}
@@ -6,6 +6,7 @@
 set -euo pipefail
 
 prefix=${1:-AY/}
+keys=${2:-3}
 
 # Generate secure staring private key
 private=$(wg genkey)
@@ -13,13 +14,17 @@ private=$(wg genkey)
 # and its public key
 public=$(echo $private | wg pubkey)
 
-# Search for prefix by incrementing $public key and report result offset.
-# Note that $private key is not involved and search can be scaled horizontally.
-offset=$(wireguard-vanity-key --prefix=$prefix --public=$public --output=offset)
+# Create job spec for the worker.
+# Note that $private key is not involved and search can be scaled horizontally
+# by giving each worker a distinct shard.
+job=$(mktemp)
+bundle=$(mktemp)
+trap 'rm -f $job $bundle' EXIT
+printf '{"public":"%s","prefix":"%s","shard":0}\n' $public $prefix > $job
 
-# Generate new private vanity key by offsetting the starting $private key.
-private_vanity=$(echo $private | wireguard-vanity-key add --offset=$offset)
+# Search for prefix by incrementing $public key and report result bundle.
+wireguard-vanity-key --job=$job --keys=$keys --output=json > $bundle
 
-# Print vanity key pair
-echo $private_vanity
-echo $private_vanity | wg pubkey
+# Generate new private vanity key pairs by offsetting the starting $private key
+# with the offsets from the result bundle.
+echo $private | wireguard-vanity-key add --bundle=$bundle
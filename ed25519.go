@@ -0,0 +1,274 @@
+package main
+
+import (
+	"context"
+	"crypto/rand"
+	"crypto/sha512"
+	"fmt"
+	"math/big"
+	"sync"
+
+	"filippo.io/edwards25519"
+	"filippo.io/edwards25519/field"
+)
+
+// Ed25519 private keys are expanded: the 32-byte scalar followed by the 32-byte nonce prefix,
+// like Tor v3 onion service secret keys.
+// Adding an offset to the scalar yields the private key of the public key at that offset
+// while the seed it was derived from is lost, so keys are not usable where the seed is required.
+
+func ed25519Generate() ([]byte, []byte, error) {
+	seed := make([]byte, 32)
+	if _, err := rand.Read(seed); err != nil {
+		return nil, nil, err
+	}
+	h := sha512.Sum512(seed)
+	h[0] &= 248
+	h[31] &= 127
+	h[31] |= 64
+
+	public, err := ed25519PublicKey(h[:])
+	if err != nil {
+		return nil, nil, err
+	}
+	return h[:], public, nil
+}
+
+func ed25519PublicKey(private []byte) ([]byte, error) {
+	s, err := ed25519Scalar(private)
+	if err != nil {
+		return nil, err
+	}
+	return new(edwards25519.Point).ScalarBaseMult(s).Bytes(), nil
+}
+
+func ed25519Add(private []byte, offset *big.Int) ([]byte, error) {
+	s, err := ed25519Scalar(private)
+	if err != nil {
+		return nil, err
+	}
+	s.Add(s, ed25519OffsetScalar(offset))
+	return append(s.Bytes(), private[32:]...), nil
+}
+
+// ed25519Scalar returns the scalar of expanded private key reduced modulo the group order.
+func ed25519Scalar(private []byte) (*edwards25519.Scalar, error) {
+	if len(private) != 64 {
+		return nil, fmt.Errorf("invalid Ed25519 private key size %d", len(private))
+	}
+	wide := make([]byte, 64)
+	copy(wide, private[:32])
+	return new(edwards25519.Scalar).SetUniformBytes(wide)
+}
+
+// ed25519Order is the order of the Ed25519 base point.
+var ed25519Order, _ = new(big.Int).SetString("7237005577332262213973186563042994961709467060941962834989935627018215233893", 10)
+
+func ed25519OffsetScalar(offset *big.Int) *edwards25519.Scalar {
+	b := new(big.Int).Mod(offset, ed25519Order).Bytes()
+	wide := make([]byte, 64)
+	for i, v := range b {
+		wide[len(b)-1-i] = v
+	}
+	s, err := new(edwards25519.Scalar).SetUniformBytes(wide)
+	if err != nil {
+		panic(err)
+	}
+	return s
+}
+
+// ed25519Multiples holds affine multiples i·B of the base point for i = 1..len
+// along with d·x·y of every multiple.
+type ed25519Multiples struct {
+	x, y, dxy []field.Element
+}
+
+var (
+	ed25519MultiplesMu    sync.Mutex
+	ed25519MultiplesCache = make(map[int]*ed25519Multiples)
+)
+
+// ed25519D is the curve constant d = -121665/121666.
+var ed25519D = func() *field.Element {
+	one := new(field.Element).One()
+	num := new(field.Element).Mult32(one, 121665)
+	den := new(field.Element).Mult32(one, 121666)
+	d := new(field.Element).Invert(den)
+	d.Multiply(d, num)
+	return d.Negate(d)
+}()
+
+func ed25519BaseMultiples(n int) *ed25519Multiples {
+	ed25519MultiplesMu.Lock()
+	defer ed25519MultiplesMu.Unlock()
+
+	if m, ok := ed25519MultiplesCache[n]; ok {
+		return m
+	}
+	m := &ed25519Multiples{
+		x:   make([]field.Element, n),
+		y:   make([]field.Element, n),
+		dxy: make([]field.Element, n),
+	}
+	zs := make([]field.Element, n)
+	p := edwards25519.NewGeneratorPoint()
+	for i := range n {
+		X, Y, Z, _ := p.ExtendedCoordinates()
+		m.x[i], m.y[i], zs[i] = *X, *Y, *Z
+		p.Add(p, edwards25519.NewGeneratorPoint())
+	}
+	batchInvert(zs, make([]field.Element, n), 1)
+	for i := range n {
+		m.x[i].Multiply(&m.x[i], &zs[i])
+		m.y[i].Multiply(&m.y[i], &zs[i])
+		m.dxy[i].Multiply(&m.x[i], &m.y[i])
+		m.dxy[i].Multiply(&m.dxy[i], ed25519D)
+	}
+	ed25519MultiplesCache[n] = m
+	return m
+}
+
+// maxChains is the maximum number of interleaved batch inversion chains.
+const maxChains = 4
+
+// batchInvert replaces elements with their inverses using a single field inversion.
+// Running products are accumulated in the given number of interleaved chains
+// so that consecutive multiplications do not depend on each other.
+func batchInvert(v, scratch []field.Element, chains int) {
+	var acc, inv [maxChains]field.Element
+	for j := 0; j < chains; j++ {
+		acc[j].One()
+	}
+	for i, j := 0, 0; i < len(v); i++ {
+		scratch[i] = acc[j]
+		acc[j].Multiply(&acc[j], &v[i])
+		if j++; j == chains {
+			j = 0
+		}
+	}
+
+	// Invert the product of all chains once and recover inverse of each chain
+	var all, t field.Element
+	all.One()
+	for j := 0; j < chains; j++ {
+		all.Multiply(&all, &acc[j])
+	}
+	all.Invert(&all)
+	for j := 0; j < chains; j++ {
+		inv[j] = all
+		for k := 0; k < chains; k++ {
+			if k != j {
+				inv[j].Multiply(&inv[j], &acc[k])
+			}
+		}
+	}
+
+	for i, j := len(v)-1, (len(v)-1)%chains; i >= 0; i-- {
+		t.Multiply(&inv[j], &scratch[i])
+		inv[j].Multiply(&inv[j], &v[i])
+		v[i] = t
+		if j--; j < 0 {
+			j = chains - 1
+		}
+	}
+}
+
+// ed25519Search is the search backend for Ed25519 public keys.
+// Like the X25519 search, it adds precomputed affine multiples of the base point
+// to the current point and shares a single field inversion among all denominators of the batch.
+// With pipeline, public keys of the batch are tested while the next batch is computed.
+func ed25519Search(ctx context.Context, sp *searchParams) {
+	batchSize, chains := sp.batchSize, sp.chains
+	start, err := new(edwards25519.Point).SetBytes(sp.startPublicKey)
+	if err != nil {
+		panic(err)
+	}
+	// The first batch adds multiples 1..batchSize to the point preceding the start offset,
+	// so the search checks offsets [startOffset, startOffset+batchSize) first.
+	base := new(big.Int).Sub(sp.startOffset, big.NewInt(1))
+	p := new(edwards25519.Point).ScalarBaseMult(ed25519OffsetScalar(base))
+	p.Add(p, start)
+
+	X, Y, Z, _ := p.ExtendedCoordinates()
+	zinv := new(field.Element).Invert(Z)
+	x := *new(field.Element).Multiply(X, zinv)
+	y := *new(field.Element).Multiply(Y, zinv)
+
+	m := ed25519BaseMultiples(batchSize)
+	den := make([]field.Element, 2*batchSize)
+	scratch := make([]field.Element, 2*batchSize)
+	xs := make([]field.Element, batchSize)
+	ys := make([]field.Element, batchSize)
+
+	// next encodes public keys of the batch that follows the current point into pubs
+	// and moves the current point to the last of them.
+	one := new(field.Element).One()
+	var xy, t, u field.Element
+	next := func(pubs []byte) {
+		// (x, y) + (x_i, y_i) = ((x·y_i + y·x_i) / (1 + d·x·y·x_i·y_i), (y·y_i + x·x_i) / (1 - d·x·y·x_i·y_i))
+		xy.Multiply(&x, &y)
+		for i := range batchSize {
+			t.Multiply(&xy, &m.dxy[i])
+			den[2*i].Add(one, &t)
+			den[2*i+1].Subtract(one, &t)
+
+			xs[i].Multiply(&x, &m.y[i])
+			u.Multiply(&y, &m.x[i])
+			xs[i].Add(&xs[i], &u)
+
+			ys[i].Multiply(&y, &m.y[i])
+			u.Multiply(&x, &m.x[i])
+			ys[i].Add(&ys[i], &u)
+		}
+		batchInvert(den, scratch, chains)
+
+		for i := range batchSize {
+			xs[i].Multiply(&xs[i], &den[2*i])
+			ys[i].Multiply(&ys[i], &den[2*i+1])
+
+			pub := pubs[32*i : 32*i+32]
+			copy(pub, ys[i].Bytes())
+			pub[31] |= byte(xs[i].IsNegative()) << 7
+		}
+		x, y = xs[batchSize-1], ys[batchSize-1]
+	}
+
+	offset := new(big.Int)
+	check := func(pubs []byte) {
+		for i := range batchSize {
+			if pub := pubs[32*i : 32*i+32]; sp.test(pub) {
+				offset.SetInt64(int64(i + 1))
+				sp.found(pub, offset.Add(offset, base))
+			}
+		}
+		base.Add(base, big.NewInt(int64(batchSize)))
+		sp.progress(batchSize)
+	}
+
+	if !sp.pipeline {
+		pubs := make([]byte, 32*batchSize)
+		for ctx.Err() == nil {
+			next(pubs)
+			check(pubs)
+		}
+		return
+	}
+
+	// Check the batch while the next one is computed by another goroutine
+	free := make(chan []byte, 2)
+	free <- make([]byte, 32*batchSize)
+	free <- make([]byte, 32*batchSize)
+	full := make(chan []byte)
+	go func() {
+		defer close(full)
+		for ctx.Err() == nil {
+			pubs := <-free
+			next(pubs)
+			full <- pubs
+		}
+	}()
+	for pubs := range full {
+		check(pubs)
+		free <- pubs
+	}
+}
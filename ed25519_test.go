@@ -0,0 +1,86 @@
+package main
+
+import (
+	"bytes"
+	"context"
+	"fmt"
+	"math/big"
+	"testing"
+
+	"filippo.io/edwards25519/field"
+)
+
+func TestEd25519Search(t *testing.T) {
+	const batchSize, batches = 64, 3
+
+	private, public, err := ed25519Generate()
+	if err != nil {
+		t.Fatal(err)
+	}
+	startOffset := new(big.Int).Lsh(big.NewInt(12345), 70)
+
+	for chains := 1; chains <= maxChains; chains++ {
+		for _, pipeline := range []bool{false, true} {
+			t.Run(fmt.Sprintf("chains=%d,pipeline=%t", chains, pipeline), func(t *testing.T) {
+				ctx, cancel := context.WithCancel(context.Background())
+				defer cancel()
+
+				var checked int
+				next := new(big.Int).Set(startOffset)
+				ed25519Search(ctx, &searchParams{
+					startPublicKey: public,
+					startOffset:    startOffset,
+					batchSize:      batchSize,
+					chains:         chains,
+					pipeline:       pipeline,
+					test:           func([]byte) bool { return true },
+					found: func(publicKey []byte, offset *big.Int) {
+						if offset.Cmp(next) != 0 {
+							t.Fatalf("got offset %s, want %s", offset, next)
+						}
+						next.Add(next, big.NewInt(1))
+
+						vanityPrivateKey, err := ed25519Add(private, offset)
+						if err != nil {
+							t.Fatal(err)
+						}
+						vanityPublicKey, err := ed25519PublicKey(vanityPrivateKey)
+						if err != nil {
+							t.Fatal(err)
+						}
+						if !bytes.Equal(vanityPublicKey, publicKey) {
+							t.Fatalf("public key mismatch at offset %s", offset)
+						}
+					},
+					progress: func(n int) {
+						if checked += n; checked >= batches*batchSize {
+							cancel()
+						}
+					},
+				})
+				if checked < batches*batchSize {
+					t.Fatalf("checked %d keys, want at least %d", checked, batches*batchSize)
+				}
+			})
+		}
+	}
+}
+
+func TestBatchInvert(t *testing.T) {
+	for chains := 1; chains <= maxChains; chains++ {
+		for _, n := range []int{1, 2, 3, 5, 8, 13} {
+			v := make([]field.Element, n)
+			want := make([]field.Element, n)
+			for i := range v {
+				v[i].Mult32(new(field.Element).One(), uint32(7*i+3))
+				want[i].Invert(&v[i])
+			}
+			batchInvert(v, make([]field.Element, n), chains)
+			for i := range v {
+				if v[i].Equal(&want[i]) != 1 {
+					t.Errorf("chains %d, n %d: wrong inverse at %d", chains, n, i)
+				}
+			}
+		}
+	}
+}
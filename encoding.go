@@ -0,0 +1,158 @@
+package main
+
+import (
+	"crypto/sha3"
+	"encoding/base32"
+	"encoding/base64"
+	"encoding/hex"
+	"fmt"
+	"slices"
+	"strings"
+)
+
+// keyEncoding is a text encoding of keys that patterns match.
+type keyEncoding struct {
+	name string
+	// alphabet lists symbols in the order of their values.
+	alphabet string
+	// bits is the number of public key bits encoded by a symbol.
+	bits int
+	// symbols is the number of symbols that encode public key.
+	symbols int
+	// prefix precedes encoded public key, patterns may omit it.
+	prefix string
+	// padding follows encoded public key, patterns may omit it.
+	padding string
+	// foldCase is set when symbols are case-insensitive.
+	foldCase bool
+	// keyType is the only key type the encoding applies to, nil for any.
+	keyType *keyType
+
+	public  func([]byte) string
+	private func([]byte) string
+}
+
+var (
+	base64Encoding = &keyEncoding{
+		name:     "base64",
+		alphabet: base64Alphabet,
+		bits:     6,
+		symbols:  publicKeySymbols,
+		padding:  "=",
+		public:   base64.StdEncoding.EncodeToString,
+		private:  base64.StdEncoding.EncodeToString,
+	}
+
+	hexEncoding = &keyEncoding{
+		name:     "hex",
+		alphabet: "0123456789abcdef",
+		bits:     4,
+		symbols:  64,
+		prefix:   "0x",
+		foldCase: true,
+		public:   hex.EncodeToString,
+		private:  hex.EncodeToString,
+	}
+
+	// onionEncoding encodes Ed25519 keys as Tor v3 onion addresses.
+	// The last address symbols mix public key bits with the checksum so patterns may not cover them.
+	onionEncoding = &keyEncoding{
+		name:     "onion",
+		alphabet: "abcdefghijklmnopqrstuvwxyz234567",
+		bits:     5,
+		symbols:  51,
+		foldCase: true,
+		keyType:  ed25519KeyType,
+		public:   onionAddress,
+		private:  base64.StdEncoding.EncodeToString,
+	}
+
+	// bech32Encoding encodes X25519 keys as age recipients and identities.
+	bech32Encoding = &keyEncoding{
+		name:     "bech32",
+		alphabet: bech32Alphabet,
+		bits:     5,
+		symbols:  52,
+		prefix:   "age1",
+		foldCase: true,
+		keyType:  x25519KeyType,
+		public: func(pub []byte) string {
+			return bech32Encode("age", pub)
+		},
+		private: func(priv []byte) string {
+			return strings.ToUpper(bech32Encode("age-secret-key-", priv))
+		},
+	}
+)
+
+func keyEncodingByName(name string) (*keyEncoding, error) {
+	switch name {
+	case "", "base64":
+		return base64Encoding, nil
+	case "hex":
+		return hexEncoding, nil
+	case "bech32":
+		return bech32Encoding, nil
+	case "onion":
+		return onionEncoding, nil
+	}
+	return nil, fmt.Errorf("unknown encoding %q", name)
+}
+
+// check returns error if the encoding does not apply to keys of the key type.
+func (e *keyEncoding) check(kt *keyType) error {
+	if e.keyType != nil && e.keyType != kt {
+		return fmt.Errorf("%s encoding requires %s keys", e.name, e.keyType.name)
+	}
+	return nil
+}
+
+// all returns the set of all symbol values.
+func (e *keyEncoding) all() uint64 {
+	return ^uint64(0) >> (64 - len(e.alphabet))
+}
+
+// symbolBit returns set bit of symbol c or zero if c is not a symbol of the encoding.
+func (e *keyEncoding) symbolBit(c byte, ignoreCase bool) uint64 {
+	if e == base64Encoding {
+		return symbolBit(c, ignoreCase)
+	}
+	if e.foldCase && c >= 'A' && c <= 'Z' {
+		c += 'a' - 'A'
+	}
+	if i := strings.IndexByte(e.alphabet, c); i >= 0 {
+		return 1 << i
+	}
+	return 0
+}
+
+// lastSymbolValues returns the set of values of the last symbol
+// which is padded with zero bits beyond the public key length.
+func (e *keyEncoding) lastSymbolValues() uint64 {
+	if e.bits*e.symbols <= 256 {
+		return e.all()
+	}
+	var set uint64
+	for v := 0; v < len(e.alphabet); v += 1 << (e.bits*e.symbols - 256) {
+		set |= 1 << v
+	}
+	return set
+}
+
+// onionAddress returns Tor v3 onion address of Ed25519 public key.
+func onionAddress(pub []byte) string {
+	const version = 3
+	checksum := sha3.Sum256(append([]byte(".onion checksum"+string(pub)), version))
+	data := append(append(slices.Clip(pub), checksum[:2]...), version)
+	return strings.ToLower(base32.StdEncoding.EncodeToString(data)) + ".onion"
+}
+
+// symbol returns the value of symbol at the position of encoded public key.
+func (e *keyEncoding) symbol(pub []byte, pos int) int {
+	bit := e.bits * pos
+	v := uint(pub[bit/8]) << 8
+	if bit/8+1 < len(pub) {
+		v |= uint(pub[bit/8+1])
+	}
+	return int(v >> (16 - e.bits - bit%8) & (1<<e.bits - 1))
+}
@@ -0,0 +1,392 @@
+package main
+
+import (
+	"cmp"
+	"fmt"
+	"math"
+	"slices"
+	"strconv"
+	"strings"
+)
+
+// Pattern expressions combine primitives with "&" (and), "|" (or), "!" (not) and parentheses:
+//
+//	prefix(gw) & suffix(Q=)
+//	(prefix(A) | prefix(B)) & !contains(/+)
+//
+// Primitives take glob patterns:
+//
+//	prefix(p)   - encoded public key starts with p
+//	suffix(p)   - encoded public key ends with p, the trailing "=" is optional
+//	at(n, p)    - p starts at symbol position n
+//	contains(p) - p is found anywhere in the encoded public key
+
+type exprOp uint8
+
+const (
+	exprAnd exprOp = iota
+	exprOr
+	exprNot
+	exprMask
+	exprTest
+)
+
+// exprNode is a node of pattern expression.
+type exprNode struct {
+	op   exprOp
+	sub  []*exprNode
+	mask maskedBits
+	test func([]byte) bool
+	// p is the probability that random public key matches
+	p float64
+	// cost is the expected relative cost of evaluation
+	cost float64
+}
+
+// Relative costs of primitive tests.
+const (
+	maskCost  = 1
+	globCost  = 2
+	regexCost = 8
+)
+
+// compileExpr compiles pattern expression into a single test function.
+// Conjunctions of masked primitives are merged into a single masked comparison,
+// and operands are ordered so that cheap and selective tests run first.
+// It also returns the estimated probability that random public key matches.
+// With ignoreCase, patterns of all primitives are case-insensitive.
+func compileExpr(expr string, e *keyEncoding, ignoreCase bool) (func([]byte) bool, float64, error) {
+	ps := &exprParser{s: expr, e: e, ignoreCase: ignoreCase}
+	n, err := ps.parseOr()
+	if err != nil {
+		return nil, 0, err
+	}
+	if ps.skipSpace(); ps.pos != len(ps.s) {
+		return nil, 0, ps.errorf("unexpected %q", ps.s[ps.pos:])
+	}
+	n = optimizeExpr(n)
+	return n.compile(), n.p, nil
+}
+
+type exprParser struct {
+	s          string
+	pos        int
+	e          *keyEncoding
+	ignoreCase bool
+}
+
+func (ps *exprParser) errorf(format string, args ...any) error {
+	return fmt.Errorf("expression %q at %d: %s", ps.s, ps.pos, fmt.Sprintf(format, args...))
+}
+
+func (ps *exprParser) skipSpace() {
+	for ps.pos < len(ps.s) && ps.s[ps.pos] == ' ' {
+		ps.pos++
+	}
+}
+
+// consume skips spaces and the byte c if it is next.
+func (ps *exprParser) consume(c byte) bool {
+	ps.skipSpace()
+	if ps.pos < len(ps.s) && ps.s[ps.pos] == c {
+		ps.pos++
+		return true
+	}
+	return false
+}
+
+func (ps *exprParser) parseOr() (*exprNode, error) {
+	n, err := ps.parseAnd()
+	if err != nil {
+		return nil, err
+	}
+	for ps.consume('|') {
+		m, err := ps.parseAnd()
+		if err != nil {
+			return nil, err
+		}
+		n = &exprNode{op: exprOr, sub: []*exprNode{n, m}}
+	}
+	return n, nil
+}
+
+func (ps *exprParser) parseAnd() (*exprNode, error) {
+	n, err := ps.parseUnary()
+	if err != nil {
+		return nil, err
+	}
+	for ps.consume('&') {
+		m, err := ps.parseUnary()
+		if err != nil {
+			return nil, err
+		}
+		n = &exprNode{op: exprAnd, sub: []*exprNode{n, m}}
+	}
+	return n, nil
+}
+
+func (ps *exprParser) parseUnary() (*exprNode, error) {
+	if ps.consume('!') {
+		n, err := ps.parseUnary()
+		if err != nil {
+			return nil, err
+		}
+		return &exprNode{op: exprNot, sub: []*exprNode{n}}, nil
+	}
+	if ps.consume('(') {
+		n, err := ps.parseOr()
+		if err != nil {
+			return nil, err
+		}
+		if !ps.consume(')') {
+			return nil, ps.errorf("missing )")
+		}
+		return n, nil
+	}
+	return ps.parsePrimitive()
+}
+
+func (ps *exprParser) parsePrimitive() (*exprNode, error) {
+	ps.skipSpace()
+	start := ps.pos
+	for ps.pos < len(ps.s) && ps.s[ps.pos] >= 'a' && ps.s[ps.pos] <= 'z' {
+		ps.pos++
+	}
+	name := ps.s[start:ps.pos]
+	if !ps.consume('(') {
+		return nil, ps.errorf("expected primitive")
+	}
+
+	position := 0
+	if name == "at" {
+		end := strings.IndexByte(ps.s[ps.pos:], ',')
+		if end < 0 {
+			return nil, ps.errorf("missing position")
+		}
+		var err error
+		if position, err = strconv.Atoi(strings.TrimSpace(ps.s[ps.pos : ps.pos+end])); err != nil {
+			return nil, ps.errorf("invalid position: %v", err)
+		}
+		ps.pos += end + 1
+	}
+
+	end := strings.IndexByte(ps.s[ps.pos:], ')')
+	if end < 0 {
+		return nil, ps.errorf("missing )")
+	}
+	pattern := strings.TrimSpace(ps.s[ps.pos : ps.pos+end])
+	ps.pos += end + 1
+
+	var n *exprNode
+	var err error
+	switch name {
+	case "prefix":
+		n, err = newPositionNode(0, pattern, ps.e, ps.ignoreCase)
+	case "at":
+		n, err = newPositionNode(position, pattern, ps.e, ps.ignoreCase)
+	case "suffix":
+		n, err = newSuffixNode(pattern, ps.e, ps.ignoreCase)
+	case "contains":
+		n, err = newContainsNode(pattern, ps.e, ps.ignoreCase)
+	default:
+		return nil, ps.errorf("unknown primitive %q", name)
+	}
+	if err != nil {
+		return nil, ps.errorf("%v", err)
+	}
+	return n, nil
+}
+
+// newPositionNode returns node that matches glob pattern at the symbol position.
+func newPositionNode(position int, pattern string, e *keyEncoding, ignoreCase bool) (*exprNode, error) {
+	if position < 0 {
+		return nil, fmt.Errorf("invalid position %d", position)
+	}
+	sets, err := parseGlob(strings.Repeat("?", position)+pattern, e, ignoreCase)
+	if err != nil {
+		return nil, err
+	}
+	return newSetsNode(sets, e)
+}
+
+// newSuffixNode returns node that matches glob pattern at the end of encoded public key.
+// Padding that follows encoded public key, like base64 "=", is optional in the pattern.
+func newSuffixNode(pattern string, e *keyEncoding, ignoreCase bool) (*exprNode, error) {
+	sets, err := parseGlob(strings.TrimSuffix(pattern, e.padding), e, ignoreCase)
+	if err != nil {
+		return nil, err
+	}
+	anySymbols := make([]uint64, e.symbols-len(sets))
+	for i := range anySymbols {
+		anySymbols[i] = e.all()
+	}
+	return newSetsNode(append(anySymbols, sets...), e)
+}
+
+func newSetsNode(sets []uint64, e *keyEncoding) (*exprNode, error) {
+	p := globProbability(sets, e)
+	if alternatives := decodePrefixMasks(sets, e); len(alternatives) == 1 {
+		return &exprNode{op: exprMask, mask: alternatives[0], p: p, cost: maskCost}, nil
+	} else if alternatives == nil {
+		test, err := newGlobTest(sets, e)
+		return &exprNode{op: exprTest, test: test, p: p, cost: regexCost}, err
+	}
+	test, err := newGlobTest(sets, e)
+	return &exprNode{op: exprTest, test: test, p: p, cost: globCost}, err
+}
+
+// newContainsNode returns node that matches glob pattern anywhere in the encoded public key.
+func newContainsNode(pattern string, e *keyEncoding, ignoreCase bool) (*exprNode, error) {
+	sets, err := parseGlob(pattern, e, ignoreCase)
+	if err != nil {
+		return nil, err
+	}
+	// Approximate probability assuming independent positions
+	p := 1 - math.Pow(1-globProbability(sets, e), float64(e.symbols-len(sets)+1))
+	if e != base64Encoding {
+		return &exprNode{op: exprTest, test: newContainsTest(sets, e), p: p, cost: regexCost}, nil
+	}
+	d, err := compileBase64Regex(globRegex(sets, false))
+	if err != nil {
+		return nil, err
+	}
+	return &exprNode{op: exprTest, test: d.match, p: p, cost: regexCost}, nil
+}
+
+// newContainsTest returns a function that tests symbol sets at every position of encoded public key.
+func newContainsTest(sets []uint64, e *keyEncoding) func([]byte) bool {
+	return func(pub []byte) bool {
+	next:
+		for start := 0; start+len(sets) <= e.symbols; start++ {
+			for i, set := range sets {
+				if set&(1<<e.symbol(pub, start+i)) == 0 {
+					continue next
+				}
+			}
+			return true
+		}
+		return false
+	}
+}
+
+// optimizeExpr flattens nested operators, merges masked primitives of conjunctions
+// and orders operands by the expected cost of evaluation.
+func optimizeExpr(n *exprNode) *exprNode {
+	switch n.op {
+	case exprNot:
+		sub := optimizeExpr(n.sub[0])
+		if sub.op == exprNot {
+			return sub.sub[0]
+		}
+		return &exprNode{op: exprNot, sub: []*exprNode{sub}, p: 1 - sub.p, cost: sub.cost}
+	case exprAnd, exprOr:
+		var sub []*exprNode
+		for _, s := range n.sub {
+			s = optimizeExpr(s)
+			if s.op == n.op {
+				sub = append(sub, s.sub...)
+			} else {
+				sub = append(sub, s)
+			}
+		}
+		if n.op == exprAnd {
+			sub = mergeMasks(sub)
+		}
+		if len(sub) == 1 {
+			return sub[0]
+		}
+
+		// An operand that decides the result with probability q at cost c
+		// should run before others in the order of ascending c/q.
+		decides := func(s *exprNode) float64 {
+			if n.op == exprAnd {
+				return 1 - s.p
+			}
+			return s.p
+		}
+		slices.SortStableFunc(sub, func(a, b *exprNode) int {
+			return cmp.Compare(a.cost*decides(b), b.cost*decides(a))
+		})
+
+		m := &exprNode{op: n.op, sub: sub}
+		continues := 1.0
+		for _, s := range sub {
+			m.cost += continues * s.cost
+			continues *= 1 - decides(s)
+		}
+		if n.op == exprAnd {
+			m.p = continues
+		} else {
+			m.p = 1 - continues
+		}
+		return m
+	}
+	return n
+}
+
+// mergeMasks merges masked operands of conjunction into one.
+func mergeMasks(sub []*exprNode) []*exprNode {
+	var merged *exprNode
+	var rest []*exprNode
+	for _, s := range sub {
+		if s.op != exprMask {
+			rest = append(rest, s)
+			continue
+		}
+		if merged == nil {
+			merged = &exprNode{op: exprMask, mask: s.mask, p: s.p, cost: maskCost}
+			continue
+		}
+		if !merged.mask.and(s.mask) {
+			// Conflicting masks never match
+			return []*exprNode{{op: exprTest, test: func([]byte) bool { return false }, p: 0, cost: 0}}
+		}
+		merged.p *= s.p
+	}
+	if merged != nil {
+		rest = append(rest, merged)
+	}
+	return rest
+}
+
+func (n *exprNode) compile() func([]byte) bool {
+	switch n.op {
+	case exprMask:
+		return newMaskedTest(n.mask)
+	case exprTest:
+		return n.test
+	case exprNot:
+		f := n.sub[0].compile()
+		return func(pub []byte) bool { return !f(pub) }
+	}
+
+	fs := make([]func([]byte) bool, len(n.sub))
+	for i, s := range n.sub {
+		fs[i] = s.compile()
+	}
+	if len(fs) == 2 {
+		a, b := fs[0], fs[1]
+		if n.op == exprAnd {
+			return func(pub []byte) bool { return a(pub) && b(pub) }
+		}
+		return func(pub []byte) bool { return a(pub) || b(pub) }
+	}
+	if n.op == exprAnd {
+		return func(pub []byte) bool {
+			for _, f := range fs {
+				if !f(pub) {
+					return false
+				}
+			}
+			return true
+		}
+	}
+	return func(pub []byte) bool {
+		for _, f := range fs {
+			if f(pub) {
+				return true
+			}
+		}
+		return false
+	}
+}
@@ -0,0 +1,56 @@
+package main
+
+import (
+	"encoding/base64"
+	"strings"
+	"testing"
+)
+
+func TestCompileExpr(t *testing.T) {
+	for _, tc := range []struct {
+		expr string
+		hint string
+		want func(s string) bool
+	}{
+		{"prefix(gw) & suffix(Q=)", "gw", func(s string) bool {
+			return strings.HasPrefix(s, "gw") && strings.HasSuffix(s, "Q=")
+		}},
+		{"(prefix(A) | prefix(B)) & !contains(/+)", "B", func(s string) bool {
+			return (s[0] == 'A' || s[0] == 'B') && !strings.Contains(s, "/+")
+		}},
+		{"at(3, x[0-9]) | suffix(g)", "...x1", func(s string) bool {
+			return s[3] == 'x' && s[4] >= '0' && s[4] <= '9' || strings.HasSuffix(s, "g=")
+		}},
+		{"!!prefix(A) & prefix(B)", "A", func(s string) bool {
+			return false
+		}},
+		{"prefix(A) & at(1, B) & !prefix(AB[0-4])", "AB", func(s string) bool {
+			return strings.HasPrefix(s, "AB") && !(s[2] >= '0' && s[2] <= '4')
+		}},
+		{"contains(AAA) | contains(zz) & prefix(?a)", "Aa.zz", func(s string) bool {
+			return strings.Contains(s, "AAA") || strings.Contains(s, "zz") && s[1] == 'a'
+		}},
+	} {
+		test, _, err := compileExpr(tc.expr, base64Encoding, false)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.expr, err)
+		}
+		ps := &exprParser{s: tc.expr, e: base64Encoding}
+		n, err := ps.parseOr()
+		if err != nil {
+			t.Fatalf("%q: %v", tc.expr, err)
+		}
+		unoptimized := n.compile()
+
+		for _, pub := range randomKeys(20000, tc.hint) {
+			s := base64.StdEncoding.EncodeToString(pub)
+			got, want := test(pub), tc.want(s)
+			if got != want {
+				t.Fatalf("%q: test(%s) = %t, want %t", tc.expr, s, got, want)
+			}
+			if u := unoptimized(pub); got != u {
+				t.Fatalf("%q: test(%s) = %t, unoptimized %t", tc.expr, s, got, u)
+			}
+		}
+	}
+}
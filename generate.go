@@ -0,0 +1,142 @@
+package main
+
+import (
+	"bytes"
+	"flag"
+	"fmt"
+	"go/format"
+	"io"
+	"os"
+	"strings"
+)
+
+// patternKey identifies the pattern of the job that generated matcher was built for.
+// It is empty for patterns that can not be generated so that they never use the generated matcher.
+func patternKey(job Job) string {
+	if job.Regex != "" || job.Expr != "" || job.Targets != "" || job.MaxMismatch > 0 {
+		return ""
+	}
+	kt, err := keyTypeByName(job.KeyType)
+	if err != nil {
+		return ""
+	}
+	if job.Mask != "" {
+		return fmt.Sprintf("key-type=%s mask=%s", kt.name, job.Mask)
+	}
+	e, err := keyEncodingByName(job.Encoding)
+	if err != nil {
+		return ""
+	}
+	return fmt.Sprintf("key-type=%s encoding=%s prefix=%s ignore-case=%t homoglyphs=%t", kt.name, e.name, job.Prefix, job.IgnoreCase, job.Homoglyphs)
+}
+
+// patternMasks returns masked alternatives of the job pattern.
+func patternMasks(job Job) ([]maskedBits, error) {
+	if patternKey(job) == "" {
+		return nil, fmt.Errorf("only prefix and mask patterns can be generated")
+	}
+	if job.Mask != "" {
+		m, err := parseMask(job.Mask)
+		return []maskedBits{m}, err
+	}
+	e, err := keyEncodingByName(job.Encoding)
+	if err != nil {
+		return nil, err
+	}
+	sets, err := parseGlob(job.Prefix, e, job.IgnoreCase)
+	if err != nil {
+		return nil, err
+	}
+	if job.Homoglyphs {
+		sets = expandHomoglyphs(sets)
+	}
+	alternatives := decodePrefixMasks(sets, e)
+	if len(alternatives) == 0 {
+		return nil, fmt.Errorf("pattern %q does not compile into up to %d masked comparisons", job.Prefix, maxGlobAlternatives)
+	}
+	return alternatives, nil
+}
+
+// cmdGenerate writes Go source of the matcher specialized for the pattern to stdout.
+// The binary built with the "generated" tag uses it for this pattern:
+// constant masks compared inline instead of a chain of function calls.
+func cmdGenerate(args []string) {
+	var job Job
+	fs := flag.NewFlagSet("generate", flag.ExitOnError)
+	fs.StringVar(&job.Prefix, "prefix", "AY/", "prefix of encoded public key, may contain \"?\" for any symbol and \"[...]\" classes")
+	fs.BoolVar(&job.IgnoreCase, "ignore-case", false, "enable case-insensitive search")
+	fs.BoolVar(&job.Homoglyphs, "homoglyphs", false, "treat look-alike symbols O/0, I/l/1 and S/5 as interchangeable in prefix")
+	fs.StringVar(&job.Mask, "mask", "", "match raw public key bytes against \"<hex value>/<hex mask>\"")
+	fs.StringVar(&job.Encoding, "encoding", "", "match public key encoded as \"base64\" (default), \"hex\", \"bech32\" age recipient or \"onion\" address")
+	fs.StringVar(&job.KeyType, "key-type", "", "search for \"x25519\" (default) or \"ed25519\" key pairs")
+	fs.Parse(args)
+
+	alternatives, err := patternMasks(job)
+	if err != nil {
+		panic(err)
+	}
+	if err := writeGeneratedMatcher(os.Stdout, patternKey(job), alternatives); err != nil {
+		panic(err)
+	}
+}
+
+// writeGeneratedMatcher writes Go source of generatedMatch that tests masked alternatives.
+func writeGeneratedMatcher(w io.Writer, key string, alternatives []maskedBits) error {
+	common := commonMaskedBits(alternatives)
+	var used [4]bool
+	for _, a := range alternatives {
+		for i, mask := range a.mask {
+			used[i] = used[i] || mask != 0
+		}
+	}
+
+	var b bytes.Buffer
+	fmt.Fprintf(&b, "// Code generated by wireguard-vanity-key generate; DO NOT EDIT.\n\n")
+	fmt.Fprintf(&b, "//go:build generated\n\npackage main\n\nimport \"encoding/binary\"\n\n")
+	fmt.Fprintf(&b, "const generatedPattern = %q\n\n", key)
+	fmt.Fprintf(&b, "func generatedMatch(pub []byte) bool {\n")
+	for i := range used {
+		if used[i] {
+			fmt.Fprintf(&b, "w%d := binary.BigEndian.Uint64(pub[%d:])\n", i, 8*i)
+		}
+	}
+	var commonCmps []string
+	for i, mask := range common.mask {
+		if mask != 0 {
+			commonCmps = append(commonCmps, fmt.Sprintf("w%d&%#016x == %#016x", i, mask, common.value[i]))
+		}
+	}
+
+	var terms []string
+	for _, a := range alternatives {
+		var cmps []string
+		for i, mask := range a.mask {
+			if rest := mask &^ common.mask[i]; rest != 0 {
+				cmps = append(cmps, fmt.Sprintf("w%d&%#016x == %#016x", i, rest, a.value[i]&rest))
+			}
+		}
+		if len(cmps) == 0 {
+			terms = nil
+			break
+		}
+		terms = append(terms, strings.Join(cmps, " && "))
+	}
+	switch {
+	case len(terms) == 0 && len(commonCmps) == 0:
+		fmt.Fprintf(&b, "return true\n}\n")
+	case len(terms) == 0:
+		fmt.Fprintf(&b, "return %s\n}\n", strings.Join(commonCmps, " &&\n"))
+	default:
+		for _, cmp := range commonCmps {
+			fmt.Fprintf(&b, "if !(%s) {\nreturn false\n}\n", cmp)
+		}
+		fmt.Fprintf(&b, "return %s\n}\n", strings.Join(terms, " ||\n"))
+	}
+
+	src, err := format.Source(b.Bytes())
+	if err != nil {
+		return err
+	}
+	_, err = w.Write(src)
+	return err
+}
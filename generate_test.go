@@ -0,0 +1,35 @@
+package main
+
+import "testing"
+
+// BenchmarkMatcher compares the compiled matcher of the README example pattern with the generated one:
+//
+//	wireguard-vanity-key generate --prefix='AY?[0-3]' > matcher_generated.go
+//	go test -tags generated -run - -bench Matcher
+func BenchmarkMatcher(b *testing.B) {
+	job := Job{Prefix: "AY?[0-3]"}
+	m, err := compileMatcher(job)
+	if err != nil {
+		b.Fatal(err)
+	}
+	keys := randomKeys(1024, "AY")
+
+	bench := func(test func([]byte) bool) func(b *testing.B) {
+		return func(b *testing.B) {
+			found := 0
+			for i := 0; i < b.N; i++ {
+				if test(keys[i%len(keys)]) {
+					found++
+				}
+			}
+			b.ReportMetric(float64(found)/float64(b.N), "matches/op")
+		}
+	}
+	b.Run("compiled", bench(m.test))
+	b.Run("generated", func(b *testing.B) {
+		if generatedPattern != patternKey(job) {
+			b.Skip("not built with the generated matcher of the pattern")
+		}
+		bench(generatedMatch)(b)
+	})
+}
@@ -0,0 +1,10 @@
+//go:build !generated
+
+package main
+
+// generatedPattern identifies the pattern of generatedMatch, see cmdGenerate.
+const generatedPattern = ""
+
+func generatedMatch(pub []byte) bool {
+	return false
+}
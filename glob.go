@@ -0,0 +1,442 @@
+package main
+
+import (
+	"encoding/binary"
+	"fmt"
+	"math/bits"
+	"slices"
+	"strings"
+)
+
+const (
+	// maxGlobAlternatives limits the number of masked alternatives,
+	// patterns that need more are matched by DFA.
+	maxGlobAlternatives = 64
+
+	// publicKeySymbols is the number of base64 symbols of public key without padding.
+	publicKeySymbols = 43
+)
+
+// isGlob reports whether prefix contains glob syntax:
+// "?" matches any symbol and "[...]" matches a class of symbols.
+func isGlob(prefix string) bool {
+	return strings.ContainsAny(prefix, "?[")
+}
+
+// parseBase64Glob returns a set of base64 symbol values for every position of the pattern.
+func parseBase64Glob(pattern string, ignoreCase bool) ([]uint64, error) {
+	return parseGlob(pattern, base64Encoding, ignoreCase)
+}
+
+// parseGlob returns a set of symbol values for every position of the pattern.
+// The pattern consists of symbols of the encoding, "?" for any symbol and "[...]" classes
+// that may contain ranges like "0-9" and may be negated by leading "!" or "^".
+// If ignoreCase is set, letters match both upper and lower case.
+func parseGlob(pattern string, e *keyEncoding, ignoreCase bool) ([]uint64, error) {
+	if e.foldCase {
+		pattern = strings.ToLower(pattern)
+	}
+	pattern = strings.TrimPrefix(pattern, e.prefix)
+
+	var sets []uint64
+	for i := 0; i < len(pattern); i++ {
+		var set uint64
+		switch c := pattern[i]; c {
+		case '?':
+			set = e.all()
+		case '[':
+			end := strings.IndexByte(pattern[i+1:], ']')
+			if end < 0 {
+				return nil, fmt.Errorf("unterminated class in %q", pattern)
+			}
+			class := pattern[i+1 : i+1+end]
+			i += 1 + end
+
+			negate := len(class) > 0 && (class[0] == '!' || class[0] == '^')
+			if negate {
+				class = class[1:]
+			}
+			for j := 0; j < len(class); j++ {
+				lo, hi := class[j], class[j]
+				if j+2 < len(class) && class[j+1] == '-' {
+					hi = class[j+2]
+					j += 2
+				}
+				if lo > hi {
+					return nil, fmt.Errorf("invalid range %c-%c in %q", lo, hi, pattern)
+				}
+				for c := lo; ; c++ {
+					set |= e.symbolBit(c, ignoreCase)
+					if c == hi {
+						break
+					}
+				}
+			}
+			if negate {
+				set = ^set & e.all()
+			}
+			if set == 0 {
+				return nil, fmt.Errorf("empty class [%s] in %q", class, pattern)
+			}
+		default:
+			if e.padding != "" && len(sets) == e.symbols && pattern[i:] == e.padding {
+				// Public key may be followed by padding, e.g. 43 base64 symbols and "="
+				i = len(pattern)
+				continue
+			}
+			if set = e.symbolBit(c, ignoreCase); set == 0 {
+				return nil, fmt.Errorf("invalid symbol %q in %q", c, pattern)
+			}
+		}
+		sets = append(sets, set)
+	}
+
+	if len(sets) > e.symbols {
+		return nil, fmt.Errorf("pattern %q is too long", pattern)
+	}
+	return sets, nil
+}
+
+// symbolBit returns set bit of base64 symbol c or zero if c is not a base64 symbol.
+func symbolBit(c byte, ignoreCase bool) uint64 {
+	var set uint64
+	if i := strings.IndexByte(base64Alphabet, c); i >= 0 {
+		set |= 1 << i
+	}
+	if ignoreCase {
+		switch {
+		case c >= 'a' && c <= 'z':
+			set |= 1 << (c - 'a')
+		case c >= 'A' && c <= 'Z':
+			set |= 1 << (c - 'A' + 26)
+		}
+	}
+	return set
+}
+
+// symbolCube matches 6-bit symbol values v such that v&mask == value.
+type symbolCube struct {
+	value, mask uint8
+}
+
+// symbolCubes returns the smallest set of cubes that covers the set of symbol values exactly.
+func symbolCubes(set uint64) []symbolCube {
+	if set == ^uint64(0) {
+		return []symbolCube{{0, 0}}
+	}
+
+	// Find prime implicants: cubes within the set that are not contained in larger cubes.
+	covers := func(c symbolCube) uint64 {
+		var s uint64
+		for v := range 64 {
+			if uint8(v)&c.mask == c.value {
+				s |= 1 << v
+			}
+		}
+		return s
+	}
+	var primes []symbolCube
+	var primeCovers []uint64
+	for mask := range 64 {
+		for value := range 64 {
+			c := symbolCube{uint8(value), uint8(mask)}
+			if c.value&^c.mask != 0 {
+				continue
+			}
+			cs := covers(c)
+			if cs&set != cs {
+				continue
+			}
+			prime := true
+			for b := range 6 {
+				bit := uint8(1) << b
+				if c.mask&bit != 0 {
+					if ls := covers(symbolCube{c.value &^ bit, c.mask &^ bit}); ls&set == ls {
+						prime = false
+						break
+					}
+				}
+			}
+			if prime {
+				primes = append(primes, c)
+				primeCovers = append(primeCovers, cs)
+			}
+		}
+	}
+
+	// Find the smallest cover by depth-first search
+	// branching on prime implicants that cover the lowest uncovered value.
+	var best, current []symbolCube
+	var search func(uncovered uint64)
+	search = func(uncovered uint64) {
+		if best != nil && len(current) >= len(best) {
+			return
+		}
+		if uncovered == 0 {
+			best = append([]symbolCube(nil), current...)
+			return
+		}
+		v := bits.TrailingZeros64(uncovered)
+		for i, c := range primes {
+			if primeCovers[i]&(1<<v) != 0 {
+				current = append(current, c)
+				search(uncovered &^ primeCovers[i])
+				current = current[:len(current)-1]
+			}
+		}
+	}
+	search(set)
+	return best
+}
+
+// maskedBits matches public keys such that key&mask == value,
+// where key is loaded as big-endian 64-bit words.
+type maskedBits struct {
+	value, mask [4]uint64
+}
+
+// setCube sets bits of the base64 symbol cube at the symbol position.
+func (m *maskedBits) setCube(pos int, c symbolCube) {
+	m.setBits(6*pos, 6, c)
+}
+
+// setBits sets bits of the symbol cube of the given width starting at the public key bit.
+// Bits beyond the public key length are dropped.
+func (m *maskedBits) setBits(first, width int, c symbolCube) {
+	for b := 0; b < width; b++ {
+		g := first + b
+		if g >= 256 {
+			break
+		}
+		bit := uint8(1) << (width - 1 - b)
+		if c.mask&bit != 0 {
+			word, shift := g/64, 63-g%64
+			m.mask[word] |= 1 << shift
+			if c.value&bit != 0 {
+				m.value[word] |= 1 << shift
+			}
+		}
+	}
+}
+
+// and adds bits of o to m and reports whether they do not conflict.
+func (m *maskedBits) and(o maskedBits) bool {
+	for w := range m.mask {
+		if (m.value[w]^o.value[w])&m.mask[w]&o.mask[w] != 0 {
+			return false
+		}
+		m.mask[w] |= o.mask[w]
+		m.value[w] |= o.value[w]
+	}
+	return true
+}
+
+// words returns the range of words that have mask bits set.
+func (m *maskedBits) words() (first, last int) {
+	first = len(m.mask)
+	for w, mask := range m.mask {
+		if mask != 0 {
+			first = min(first, w)
+			last = w + 1
+		}
+	}
+	return min(first, last), last
+}
+
+// newMaskedTest returns a function that tests whether public key matches masked bits.
+func newMaskedTest(m maskedBits) func([]byte) bool {
+	first, last := m.words()
+	if last-first == 1 {
+		value, mask, offset := m.value[first], m.mask[first], 8*first
+		return func(pub []byte) bool {
+			return binary.BigEndian.Uint64(pub[offset:])&mask == value
+		}
+	}
+	return func(pub []byte) bool {
+		for w := first; w < last; w++ {
+			if binary.BigEndian.Uint64(pub[8*w:])&m.mask[w] != m.value[w] {
+				return false
+			}
+		}
+		return true
+	}
+}
+
+// decodePrefixMasks returns masked alternatives that match glob prefix pattern
+// or nil if there are more than maxGlobAlternatives of them.
+func decodePrefixMasks(sets []uint64, e *keyEncoding) []maskedBits {
+	alternatives := []maskedBits{{}}
+	for pos, set := range sets {
+		if pos == e.symbols-1 {
+			// The last symbol is padded with zero bits, e.g. base64 symbol encodes four bits
+			set &= e.lastSymbolValues()
+		}
+		cubes := symbolCubes(set)
+		if len(alternatives)*len(cubes) > maxGlobAlternatives {
+			return nil
+		}
+		next := make([]maskedBits, 0, len(alternatives)*len(cubes))
+		for _, a := range alternatives {
+			for _, c := range cubes {
+				alt := a
+				// Symbols narrower than six bits have upper cube bits fixed to zero
+				c.mask &= 1<<e.bits - 1
+				alt.setBits(e.bits*pos, e.bits, c)
+				next = append(next, alt)
+			}
+		}
+		alternatives = next
+	}
+	return alternatives
+}
+
+// commonMaskedBits returns bits fixed in all alternatives.
+func commonMaskedBits(alternatives []maskedBits) maskedBits {
+	common := alternatives[0]
+	for _, a := range alternatives[1:] {
+		for w := range common.mask {
+			common.mask[w] &= a.mask[w] &^ (a.value[w] ^ common.value[w])
+			common.value[w] &= common.mask[w]
+		}
+	}
+	return common
+}
+
+// newGlobTest returns a function that tests whether encoded public key prefix
+// matches symbol sets.
+func newGlobTest(sets []uint64, e *keyEncoding) (func([]byte) bool, error) {
+	alternatives := decodePrefixMasks(sets, e)
+	if alternatives == nil {
+		if e != base64Encoding {
+			return newSymbolTest(sets, e), nil
+		}
+		d, err := compileBase64Regex(globRegex(sets, true))
+		if err != nil {
+			return nil, err
+		}
+		return d.match, nil
+	}
+	if len(alternatives) == 0 {
+		return nil, fmt.Errorf("pattern can not match public key")
+	}
+
+	// Bits fixed in all alternatives reject most candidates with a single comparison.
+	common := commonMaskedBits(alternatives)
+	words := 0
+	for w, mask := range common.mask {
+		for _, a := range alternatives {
+			mask |= a.mask[w]
+		}
+		if mask != 0 {
+			words = w + 1
+		}
+	}
+	if len(alternatives) == 1 {
+		return newMaskedTest(common), nil
+	}
+
+	return func(pub []byte) bool {
+		var key [4]uint64
+		for w := range words {
+			key[w] = binary.BigEndian.Uint64(pub[8*w:])
+			if key[w]&common.mask[w] != common.value[w] {
+				return false
+			}
+		}
+	next:
+		for i := range alternatives {
+			a := &alternatives[i]
+			for w := range words {
+				if key[w]&a.mask[w] != a.value[w] {
+					continue next
+				}
+			}
+			return true
+		}
+		return false
+	}, nil
+}
+
+// newSymbolTest returns a function that tests public key symbols one by one.
+func newSymbolTest(sets []uint64, e *keyEncoding) func([]byte) bool {
+	return func(pub []byte) bool {
+		for pos, set := range sets {
+			if set&(1<<e.symbol(pub, pos)) == 0 {
+				return false
+			}
+		}
+		return true
+	}
+}
+
+// homoglyphs are groups of base64 symbols that look alike.
+var homoglyphs = []string{"O0", "Il1", "S5"}
+
+// expandHomoglyphs returns symbol sets extended with look-alike symbols.
+func expandHomoglyphs(sets []uint64) []uint64 {
+	expanded := slices.Clone(sets)
+	for _, group := range homoglyphs {
+		var g uint64
+		for _, c := range []byte(group) {
+			g |= symbolBit(c, false)
+		}
+		for i, set := range sets {
+			if set&g != 0 {
+				expanded[i] |= g
+			}
+		}
+	}
+	return expanded
+}
+
+// globProbability returns the probability that random public key matches symbol sets.
+func globProbability(sets []uint64, e *keyEncoding) float64 {
+	p := 1.0
+	for _, set := range sets {
+		p *= float64(bits.OnesCount64(set)) / float64(len(e.alphabet))
+	}
+	return p
+}
+
+// globDistance returns the number of positions where public key symbol is not in the set.
+func globDistance(pub []byte, sets []uint64) int {
+	d := 0
+	for pos, set := range sets {
+		if set&(1<<base64Symbol(pub, pos)) == 0 {
+			d++
+		}
+	}
+	return d
+}
+
+// base64Symbol returns the value of base64 symbol at the position of encoded public key.
+func base64Symbol(pub []byte, pos int) int {
+	bit := 6 * pos
+	v := uint(pub[bit/8]) << 8
+	if bit/8+1 < len(pub) {
+		v |= uint(pub[bit/8+1])
+	}
+	return int(v >> (10 - bit%8) & 63)
+}
+
+// globRegex returns regular expression equivalent to the glob symbol sets.
+func globRegex(sets []uint64, anchored bool) string {
+	var b strings.Builder
+	if anchored {
+		b.WriteByte('^')
+	}
+	for _, set := range sets {
+		b.WriteByte('[')
+		for i := range 64 {
+			if set&(1<<i) != 0 {
+				c := base64Alphabet[i]
+				if c == '+' || c == '/' {
+					b.WriteByte('\\')
+				}
+				b.WriteByte(c)
+			}
+		}
+		b.WriteByte(']')
+	}
+	return b.String()
+}
@@ -0,0 +1,84 @@
+package main
+
+import (
+	"encoding/base64"
+	"encoding/binary"
+	"strings"
+	"testing"
+)
+
+func TestSymbolCubes(t *testing.T) {
+	for _, set := range []uint64{1, 3, 0xf0f0, 0x3ff << 52, 0xaaaaaaaaaaaaaaaa, ^uint64(1), ^uint64(0), 1<<0 | 1<<7 | 1<<56 | 1<<63} {
+		var covered uint64
+		for v := range 64 {
+			for _, c := range symbolCubes(set) {
+				if uint8(v)&c.mask == c.value {
+					covered |= 1 << v
+				}
+			}
+		}
+		if covered != set {
+			t.Errorf("cubes of %#x cover %#x", set, covered)
+		}
+	}
+}
+
+// globReference tests encoded public key symbol by symbol.
+func globReference(s string, sets []uint64) bool {
+	for i, set := range sets {
+		if set&(1<<strings.IndexByte(base64Alphabet, s[i])) == 0 {
+			return false
+		}
+	}
+	return true
+}
+
+func TestGlobTest(t *testing.T) {
+	for _, tc := range []struct {
+		pattern    string
+		ignoreCase bool
+		hint       string
+	}{
+		{"AY?[0-9]/", false, "AYx1/"},
+		{"ab", true, "Ab"},
+		{"abcdefgh", true, "aBcDeFgH"},
+		{"[A-F][!a-z]?Q", false, "B0xQ"},
+		{"[0-9][0-9][0-9]", false, "123"},
+		{"??????????A[0-9]", false, "..........A5"},
+		{"??????????????????????????????????????????[AQgw]", false, ""},
+		{"??????????????????????????????????????????[^A]=", false, ""},
+		// Too many alternatives for masks
+		{"[AY5][bdf9][ace+][bd/f][ace0]", false, "Y9+/0"},
+	} {
+		sets, err := parseBase64Glob(tc.pattern, tc.ignoreCase)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.pattern, err)
+		}
+		test, err := newGlobTest(sets, base64Encoding)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.pattern, err)
+		}
+		alternatives := decodePrefixMasks(sets, base64Encoding)
+		for _, pub := range randomKeys(20000, tc.hint) {
+			s := base64.StdEncoding.EncodeToString(pub)
+			want := globReference(s, sets)
+			if got := test(pub); got != want {
+				t.Fatalf("%q: test(%s) = %t, want %t", tc.pattern, s, got, want)
+			}
+			if alternatives == nil {
+				continue
+			}
+			got := false
+			for _, a := range alternatives {
+				matches := true
+				for w := range a.mask {
+					matches = matches && binary.BigEndian.Uint64(pub[8*w:])&a.mask[w] == a.value[w]
+				}
+				got = got || matches
+			}
+			if got != want {
+				t.Fatalf("%q: masks match %s = %t, want %t", tc.pattern, s, got, want)
+			}
+		}
+	}
+}
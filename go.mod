@@ -2,6 +2,7 @@ module github.com/AlexanderYastrebov/wireguard-vanity-key
 
 go 1.25.0
 
-require github.com/AlexanderYastrebov/vanity25519 v0.0.0-20250902184634-03a25bd27049
-
-require filippo.io/edwards25519 v1.1.1-0.20250211130249-04b037b40df0 // indirect
+require (
+	filippo.io/edwards25519 v1.1.1-0.20250211130249-04b037b40df0
+	github.com/AlexanderYastrebov/vanity25519 v0.0.0-20250902184634-03a25bd27049
+)
@@ -0,0 +1,61 @@
+package main
+
+import (
+	"crypto/ecdh"
+	"crypto/rand"
+	"fmt"
+	"math/big"
+
+	"github.com/AlexanderYastrebov/vanity25519"
+)
+
+// keyType is a type of key pairs produced by the search.
+type keyType struct {
+	name string
+	// privateSize is the size of private key in bytes.
+	privateSize int
+	// generate returns random private key and its public key.
+	generate func() (private, public []byte, err error)
+	// publicKey returns public key of the private key.
+	publicKey func(private []byte) ([]byte, error)
+	// add returns private key of the public key found at offset from the public key of private key.
+	add func(private []byte, offset *big.Int) ([]byte, error)
+}
+
+var x25519KeyType = &keyType{
+	name:        "x25519",
+	privateSize: 32,
+	generate: func() ([]byte, []byte, error) {
+		key, err := ecdh.X25519().GenerateKey(rand.Reader)
+		if err != nil {
+			return nil, nil, err
+		}
+		return key.Bytes(), key.PublicKey().Bytes(), nil
+	},
+	publicKey: func(private []byte) ([]byte, error) {
+		key, err := ecdh.X25519().NewPrivateKey(private)
+		if err != nil {
+			return nil, err
+		}
+		return key.PublicKey().Bytes(), nil
+	},
+	add: vanity25519.Add,
+}
+
+var ed25519KeyType = &keyType{
+	name:        "ed25519",
+	privateSize: 64,
+	generate:    ed25519Generate,
+	publicKey:   ed25519PublicKey,
+	add:         ed25519Add,
+}
+
+func keyTypeByName(name string) (*keyType, error) {
+	switch name {
+	case "", "x25519":
+		return x25519KeyType, nil
+	case "ed25519":
+		return ed25519KeyType, nil
+	}
+	return nil, fmt.Errorf("unknown key type %q", name)
+}
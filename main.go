@@ -6,30 +6,36 @@
 package main
 
 import (
+	"bytes"
+	"cmp"
 	"context"
-	"crypto/ecdh"
 	"crypto/rand"
 	"encoding/base64"
+	"encoding/json"
 	"flag"
 	"fmt"
 	"io"
+	"math"
 	"math/big"
 	"os"
 	"os/signal"
 	"runtime"
+	"slices"
 	"strings"
 	"sync"
 	"sync/atomic"
 	"syscall"
 	"time"
-
-	"github.com/AlexanderYastrebov/vanity25519"
 )
 
 type SearchResult struct {
-	PublicKey []byte
-	Offset    *big.Int
-	Found     bool
+	PublicKey []byte   `json:"public"`
+	Offset    *big.Int `json:"offset"`
+	Found     bool     `json:"-"`
+	Distance  int      `json:"distance,omitempty"`
+	Score     int      `json:"score,omitempty"`
+
+	task *searchTask
 }
 
 func main() {
@@ -37,40 +43,74 @@ func main() {
 		cmdAdd(os.Args[2:])
 		return
 	}
+	if len(os.Args) > 1 && os.Args[1] == "index" {
+		cmdIndex()
+		return
+	}
+	if len(os.Args) > 1 && os.Args[1] == "generate" {
+		cmdGenerate(os.Args[2:])
+		return
+	}
 
 	start := time.Now()
 	config := struct {
-		prefix     string
-		timeout    time.Duration
-		public     string
-		output     string
-		ignoreCase bool
-		keysAmount uint64
+		timeout  time.Duration
+		output   string
+		job      string
+		coverage string
 	}{}
+	var defaults Job
 
-	flag.StringVar(&config.prefix, "prefix", "AY/", "prefix of base64-encoded public key")
+	flag.StringVar(&defaults.Prefix, "prefix", "AY/", "prefix of base64-encoded public key, may contain \"?\" for any symbol and \"[...]\" classes")
 	flag.DurationVar(&config.timeout, "timeout", 0, "stop after specified timeout")
-	flag.StringVar(&config.public, "public", "", "start from specified public key")
-	flag.StringVar(&config.output, "output", "", "use \"offset\" to print offset only")
-	flag.BoolVar(&config.ignoreCase, "ignore-case", false, "enable case-insensitive search")
-	flag.Uint64Var(&config.keysAmount, "keys", 1, "amount of keys that will be returned. 0 means infinite")
+	flag.StringVar(&defaults.Public, "public", "", "start from specified public key")
+	flag.StringVar(&config.output, "output", "", "use \"offset\" to print offset only or \"json\" to print result bundle")
+	flag.BoolVar(&defaults.IgnoreCase, "ignore-case", false, "enable case-insensitive search")
+	flag.Uint64Var(&defaults.Keys, "keys", 1, "amount of keys that will be returned. 0 means infinite")
+	flag.BoolVar(&defaults.Homoglyphs, "homoglyphs", false, "treat look-alike symbols O/0, I/l/1 and S/5 as interchangeable in prefix")
+	flag.IntVar(&defaults.MaxMismatch, "max-mismatch", 0, "allow specified amount of prefix symbols to mismatch")
+	flag.IntVar(&defaults.Top, "top", 0, "report specified amount of keys with the longest prefix match found before timeout")
+	flag.StringVar(&defaults.Regex, "regex", "", "regular expression that base64-encoded public key should match")
+	flag.StringVar(&defaults.Mask, "mask", "", "match raw public key bytes against \"<hex value>/<hex mask>\"")
+	flag.StringVar(&defaults.Targets, "targets", "", "match any prefix from file with one prefix per line or an index built by the index subcommand")
+	flag.StringVar(&defaults.Expr, "expr", "", "boolean expression of prefix(p), suffix(p), at(n, p) and contains(p) patterns combined with &, |, ! and parentheses")
+	flag.StringVar(&config.job, "job", "", "read job specs from file, use \"-\" for stdin. Flags provide defaults for job spec fields")
+	flag.Uint64Var(&defaults.Shard, "shard", 0, "search within specified shard of offsets")
+	flag.IntVar(&defaults.BatchSize, "batch", 4096, "batch size")
+	flag.IntVar(&defaults.Chains, "chains", 1, "amount of interleaved batch inversion chains, up to 4 for ed25519")
+	flag.StringVar(&defaults.Backend, "backend", "", "search backend, \"auto\" benchmarks backends of the key type and selects the fastest")
+	flag.BoolVar(&defaults.Pipeline, "pipeline", false, "test public keys of a batch while the next batch is computed, ed25519 only")
+	flag.StringVar(&config.coverage, "coverage", "", "write JSON report of checked offset ranges to specified file")
+	flag.StringVar(&defaults.KeyType, "key-type", "", "search for \"x25519\" (default) or \"ed25519\" key pairs")
+	flag.StringVar(&defaults.Encoding, "encoding", "", "match public key encoded as \"base64\" (default), \"hex\", \"bech32\" age recipient or \"onion\" address")
 	flag.Parse()
 
-	var startKey *ecdh.PrivateKey
-	var startPublicKey []byte
-	var err error
+	var defaultPrefix string
+	if !isFlagSet("prefix") {
+		defaultPrefix, defaults.Prefix = defaults.Prefix, ""
+	}
 
-	if config.public != "" {
-		startPublicKey, err = base64.StdEncoding.DecodeString(config.public)
-		if err != nil {
+	jobs := []Job{defaults}
+	if config.job != "" {
+		var err error
+		if jobs, err = readJobs(config.job, defaults); err != nil {
 			panic(err)
 		}
-	} else {
-		startKey, err = ecdh.X25519().GenerateKey(rand.Reader)
-		if err != nil {
-			panic(err)
+	}
+	for i, job := range jobs {
+		// The default prefix is base64 and applies to jobs without a pattern
+		if job.Prefix == "" && !job.hasPattern() && (job.Encoding == "" || job.Encoding == base64Encoding.name) {
+			jobs[i].Prefix = defaultPrefix
 		}
-		startPublicKey = startKey.PublicKey().Bytes()
+	}
+	if len(jobs) > 1 && config.output != "json" {
+		panic("multiple jobs require json output")
+	}
+
+	tasks := make([]*searchTask, len(jobs))
+	for i, job := range jobs {
+		tasks[i] = newSearchTask(job)
+		printEstimate(tasks[i])
 	}
 
 	ctx, cancel := signal.NotifyContext(context.Background(), syscall.SIGINT, syscall.SIGTERM)
@@ -81,27 +121,6 @@ func main() {
 		defer cancel()
 	}
 
-	var test func([]byte) bool
-	if config.ignoreCase {
-		prefixUpper := []byte(strings.ToUpper(config.prefix))
-		test = func(pub []byte) bool {
-			buf := make([]byte, base64.StdEncoding.EncodedLen(len(pub)))
-			base64.StdEncoding.Encode(buf, pub)
-			for i := 0; i < len(prefixUpper) && i < len(buf); i++ {
-				a := buf[i]
-				if a >= 'a' && a <= 'z' {
-					a -= 'a' - 'A'
-				}
-				if a != prefixUpper[i] {
-					return false
-				}
-			}
-			return len(buf) >= len(prefixUpper)
-		}
-	} else {
-		test = vanity25519.HasPrefixBits(decodeBase64PrefixBits(config.prefix))
-	}
-
 	sigs := make(chan os.Signal, 1)
 	signal.Notify(sigs, os.Interrupt, syscall.SIGTERM)
 	go func() {
@@ -110,17 +129,37 @@ func main() {
 	}()
 
 	var totalAttempts atomic.Uint64
-	results := searchParallel(ctx, runtime.GOMAXPROCS(0), startPublicKey, test, &totalAttempts, config.keysAmount)
-	ok := printParallel(results, startKey, config.prefix, start, &totalAttempts)
+	results := searchParallel(ctx, runtime.GOMAXPROCS(0), tasks, &totalAttempts)
+	if slices.ContainsFunc(tasks, func(t *searchTask) bool { return t.job.Targets != "" }) {
+		go watchTargets(ctx, tasks)
+	}
+	ok := printParallel(results, tasks, config.output, start, &totalAttempts)
+
+	if config.coverage != "" {
+		if err := writeCoverage(config.coverage, tasks, totalAttempts.Load(), time.Since(start)); err != nil {
+			panic(err)
+		}
+	}
 
 	if !ok {
 		os.Exit(1)
 	}
 }
 
+func isFlagSet(name string) bool {
+	set := false
+	flag.Visit(func(f *flag.Flag) {
+		set = set || f.Name == name
+	})
+	return set
+}
+
 func cmdAdd(args []string) {
 	config := struct {
-		offset *big.Int
+		offset   *big.Int
+		bundle   string
+		encoding string
+		keyType  string
 	}{}
 	var ok bool
 
@@ -131,58 +170,453 @@ func cmdAdd(args []string) {
 		}
 		return nil
 	})
+	fs.StringVar(&config.bundle, "bundle", "", "add offsets from specified result bundle file")
+	fs.StringVar(&config.encoding, "encoding", "", "print private key encoded as \"base64\" (default), \"hex\" or \"bech32\" age identity, result bundle specifies its own encoding")
+	fs.StringVar(&config.keyType, "key-type", "", "private key type \"x25519\" (default) or \"ed25519\", result bundle specifies its own key type")
 	fs.Parse(args)
 
-	if config.offset == nil {
-		panic("offset required")
+	if config.offset == nil && config.bundle == "" {
+		panic("offset or bundle required")
 	}
 
-	in := make([]byte, 44)
+	if config.bundle != "" {
+		bundles, err := readBundles(config.bundle)
+		if err != nil {
+			panic(err)
+		}
+		kt, err := keyTypeByName(bundles[0].Job.KeyType)
+		if err != nil {
+			panic(err)
+		}
+		startPrivateKey := readPrivateKey(kt)
+		startPublicKey, err := kt.publicKey(startPrivateKey)
+		if err != nil {
+			panic(err)
+		}
+		// A stream of several jobs may contain bundles of other starting keys,
+		// skip them before printing anything.
+		public := base64.StdEncoding.EncodeToString(startPublicKey)
+		bundles = slices.DeleteFunc(bundles, func(bundle *ResultBundle) bool {
+			if bundle.Job.Public != public {
+				fmt.Fprintf(os.Stderr, "Skipping bundle of job %s: public key does not match private key\n", bundle.Job.name())
+				return true
+			}
+			return false
+		})
+		if len(bundles) == 0 {
+			panic("bundle public key does not match private key")
+		}
+		for _, bundle := range bundles {
+			addBundle(bundle, startPrivateKey)
+		}
+		return
+	}
+
+	kt, err := keyTypeByName(config.keyType)
+	if err != nil {
+		panic(err)
+	}
+	enc, err := keyEncodingByName(config.encoding)
+	if err != nil {
+		panic(err)
+	}
+	if err := enc.check(kt); err != nil {
+		panic(err)
+	}
+	vanityPrivateKey, err := kt.add(readPrivateKey(kt), config.offset)
+	if err != nil {
+		panic(err)
+	}
+	fmt.Println(enc.private(vanityPrivateKey))
+}
+
+// readPrivateKey reads base64-encoded private key from stdin.
+func readPrivateKey(kt *keyType) []byte {
+	in := make([]byte, base64.StdEncoding.EncodedLen(kt.privateSize))
 	if _, err := io.ReadFull(os.Stdin, in); err != nil {
 		panic(err)
 	}
-	startPrivateKey, err := base64.StdEncoding.DecodeString(string(in))
+	private, err := base64.StdEncoding.DecodeString(string(in))
+	if err != nil {
+		panic(err)
+	}
+	return private
+}
+
+// cmdIndex reads targets, one per line, from stdin and writes the sorted target table to stdout.
+func cmdIndex() {
+	table, quotas, err := parseTargets(os.Stdin)
+	if err != nil {
+		panic(err)
+	}
+	if quotas != nil {
+		panic("index does not support quotas")
+	}
+	if _, err := os.Stdout.Write(table); err != nil {
+		panic(err)
+	}
+}
+
+// addBundle prints vanity key pairs for all results of the bundle.
+// It verifies that the bundle was produced for the starting private key
+// and that every result public key matches the derived private key.
+func addBundle(bundle *ResultBundle, startPrivateKey []byte) {
+	kt, err := keyTypeByName(bundle.Job.KeyType)
+	if err != nil {
+		panic(err)
+	}
+	enc, err := keyEncodingByName(bundle.Job.Encoding)
 	if err != nil {
 		panic(err)
 	}
+	if err := enc.check(kt); err != nil {
+		panic(err)
+	}
 
-	vanityPrivateKey, err := vanity25519.Add(startPrivateKey, config.offset)
+	startPublicKey, err := kt.publicKey(startPrivateKey)
 	if err != nil {
 		panic(err)
 	}
-	fmt.Println(base64.StdEncoding.EncodeToString(vanityPrivateKey))
+	if bundle.Job.Public != base64.StdEncoding.EncodeToString(startPublicKey) {
+		panic("bundle public key does not match private key")
+	}
+
+	vanityPrivateKey := func(r SearchResult) []byte {
+		vanityPrivateKey, err := kt.add(startPrivateKey, r.Offset)
+		if err != nil {
+			panic(err)
+		}
+		vanityPublicKey, err := kt.publicKey(vanityPrivateKey)
+		if err != nil {
+			panic(err)
+		}
+		if !bytes.Equal(vanityPublicKey, r.PublicKey) {
+			panic(fmt.Sprintf("invalid offset %s for public key %s", r.Offset, base64.StdEncoding.EncodeToString(r.PublicKey)))
+		}
+		return vanityPrivateKey
+	}
+	for _, r := range bundle.Results {
+		fmt.Println(enc.private(vanityPrivateKey(r)), enc.public(r.PublicKey))
+	}
+	// Best keys are marked with the number of matching bits
+	for _, r := range bundle.Best {
+		fmt.Println(enc.private(vanityPrivateKey(r)), enc.public(r.PublicKey), "best", r.Score)
+	}
 }
 
-func searchParallel(ctx context.Context, workers int, startPublicKey []byte, test func([]byte) bool, totalAttempts *atomic.Uint64, keysAmount uint64) <-chan SearchResult {
+// printEstimate prints expected amount of attempts per key to stderr.
+func printEstimate(t *searchTask) {
+	m := t.matcher.Load()
+	if m.speedup != 0 {
+		fmt.Fprintf(os.Stderr, "Approximate match speeds up search for %s %.1f times\n", t.job.Prefix, m.speedup)
+	}
+	if m.probability != 0 {
+		fmt.Fprintf(os.Stderr, "Expected %.0f attempts per key\n", 1/m.probability)
+	}
+}
+
+// private returns encoded vanity private key or "-" for blind search.
+func (r SearchResult) private() string {
+	if r.task.startKey != nil {
+		if vanityPrivateKey, err := r.task.keyType.add(r.task.startKey, r.Offset); err == nil {
+			return r.task.enc.private(vanityPrivateKey)
+		}
+	}
+	return "-"
+}
+
+// public returns encoded public key.
+func (r SearchResult) public() string {
+	return r.task.enc.public(r.PublicKey)
+}
+
+// searchTask is a search around a single starting public key.
+type searchTask struct {
+	job            Job
+	startKey       []byte
+	startPublicKey []byte
+	keyType        *keyType
+	backend        *backend
+	enc            *keyEncoding
+	// matcher is replaced when target set changes,
+	// workers pick up the new one on the next batch.
+	matcher atomic.Pointer[matcher]
+
+	ctx      context.Context
+	cancel   context.CancelFunc
+	found    atomic.Uint64
+	attempts atomic.Uint64
+
+	mu      sync.Mutex
+	covered []OffsetRange
+
+	// top holds the best keys found by each worker
+	top []*topKeys
+}
+
+func newSearchTask(job Job) *searchTask {
+	if job.BatchSize <= 0 {
+		panic(fmt.Sprintf("job %s: batch size must be positive, got %d", job.name(), job.BatchSize))
+	}
+	m, err := newMatcher(job)
+	if err != nil {
+		panic(err)
+	}
+	t := &searchTask{job: job}
+	t.matcher.Store(m)
+	if t.enc, err = keyEncodingByName(job.Encoding); err != nil {
+		panic(err)
+	}
+	if t.keyType, err = keyTypeByName(job.KeyType); err != nil {
+		panic(err)
+	}
+	if err := t.enc.check(t.keyType); err != nil {
+		panic(err)
+	}
+	if t.job.Chains == 0 {
+		t.job.Chains = 1
+	}
+	if t.backend, t.job.Pipeline, err = selectBackend(t.job, t.keyType, m.test); err != nil {
+		panic(err)
+	}
+	if t.job.Chains < 0 || t.job.Chains > t.backend.maxChains {
+		panic(fmt.Sprintf("%s backend supports up to %d chains", t.backend.name, t.backend.maxChains))
+	}
+	if t.job.Pipeline && !t.backend.canPipeline {
+		panic(fmt.Sprintf("%s backend does not support pipeline", t.backend.name))
+	}
+	if m.quotas != nil && m.quotas.limited() {
+		// The search ends when all quotas are met
+		t.job.Keys = 0
+	}
+
+	if job.Public != "" {
+		t.startPublicKey, err = base64.StdEncoding.DecodeString(job.Public)
+		if err != nil {
+			panic(err)
+		}
+	} else {
+		t.startKey, t.startPublicKey, err = t.keyType.generate()
+		if err != nil {
+			panic(err)
+		}
+		t.job.Public = base64.StdEncoding.EncodeToString(t.startPublicKey)
+	}
+	return t
+}
+
+// search runs the search until ctx is done and sends found keys to results.
+// It records the range of offsets checked by the worker.
+// It calls yield once per batch to let searches of other tasks of the worker run.
+func (t *searchTask) search(ctx context.Context, worker int, results chan<- SearchResult, totalAttempts *atomic.Uint64, yield func()) {
+	m := t.matcher.Load()
+	// Only target lists replace the matcher, on reload or when a quota is met
+	replaceable := t.job.Targets != ""
+
+	// Backends report progress once per batch
+	// to avoid contention on the shared counters.
+	var checked uint64
+	progress := func(n int) {
+		attempts := uint64(n)
+		t.attempts.Add(attempts)
+		totalAttempts.Add(attempts)
+		checked += attempts
+		yield()
+		if replaceable {
+			m = t.matcher.Load()
+		}
+	}
+
+	// Keys that score high enough to get into the top are reported by Search
+	// just like matching keys.
+	var top *topKeys
+	threshold := math.MaxInt
+	if t.top != nil && m.score != nil {
+		top = t.top[worker]
+		threshold = top.threshold()
+	}
+
+	// The matcher is passed to the backend directly unless it is replaced or scores keys
+	var test func([]byte) bool
+	switch {
+	case top != nil:
+		test = func(publicKey []byte) bool {
+			return m.test(publicKey) || m.score(publicKey) >= threshold
+		}
+	case replaceable:
+		test = func(publicKey []byte) bool {
+			return m.test(publicKey)
+		}
+	default:
+		test = m.test
+	}
+
+	startOffset := shardOffset(t.job.Shard)
+	// dropped is the amount of offsets checked before the first match
+	// that was dropped because the task was complete.
+	var dropped *big.Int
+	found := func(publicKey []byte, offset *big.Int) {
+		if top != nil && !m.test(publicKey) {
+			top.push(SearchResult{
+				PublicKey: append([]byte(nil), publicKey...),
+				Offset:    new(big.Int).Set(offset),
+				Score:     m.score(publicKey),
+				task:      t,
+			})
+			threshold = top.threshold()
+			return
+		}
+
+		var done bool
+		if m.quotas != nil {
+			var ok bool
+			if ok, done = m.quotas.claim(publicKey, t.matcher.Store); !ok {
+				return
+			}
+		}
+
+		r := SearchResult{
+			PublicKey: append([]byte(nil), publicKey...),
+			Offset:    new(big.Int).Set(offset),
+			Found:     true,
+			task:      t,
+		}
+		if m.rank != nil {
+			r.Distance = m.rank(publicKey)
+		}
+		select {
+		case results <- r:
+		case <-t.ctx.Done():
+			if dropped == nil {
+				dropped = new(big.Int).Sub(offset, startOffset)
+			}
+			return
+		}
+
+		if t.found.Add(1) >= t.job.Keys && t.job.Keys != 0 || done {
+			t.cancel()
+		}
+	}
+
+	t.backend.search(ctx, &searchParams{
+		startPublicKey: t.startPublicKey,
+		startOffset:    startOffset,
+		batchSize:      t.job.BatchSize,
+		chains:         t.job.Chains,
+		pipeline:       t.job.Pipeline,
+		test:           test,
+		found:          found,
+		progress:       progress,
+	})
+
+	// The range ends before the dropped match so that it covers only delivered results
+	if dropped != nil && dropped.IsUint64() {
+		checked = min(checked, dropped.Uint64())
+	}
+	t.mu.Lock()
+	t.covered = append(t.covered, OffsetRange{Worker: worker, Start: startOffset, Count: checked})
+	t.mu.Unlock()
+}
+
+// reloadTargets recompiles the matcher from the reloaded target list and swaps it in.
+// Workers pick up the new matcher on the next batch
+// and keys already found count towards quotas of the reloaded list.
+func (t *searchTask) reloadTargets() error {
+	m, err := newMatcher(t.job)
+	if err != nil {
+		return err
+	}
+	if t.matcher.Load().quotas.replace(m.quotas, t.matcher.Store) {
+		t.cancel()
+	}
+	return nil
+}
+
+// targetsPollInterval is the interval of target list modification checks.
+const targetsPollInterval = time.Second
+
+// watchTargets reloads target lists on SIGHUP or when the file is modified.
+func watchTargets(ctx context.Context, tasks []*searchTask) {
+	hup := make(chan os.Signal, 1)
+	signal.Notify(hup, syscall.SIGHUP)
+	defer signal.Stop(hup)
+
+	modTime := func(name string) time.Time {
+		if fi, err := os.Stat(name); err == nil {
+			return fi.ModTime()
+		}
+		return time.Time{}
+	}
+	modified := make(map[string]time.Time)
+	for _, t := range tasks {
+		if t.job.Targets != "" {
+			modified[t.job.Targets] = modTime(t.job.Targets)
+		}
+	}
+
+	ticker := time.NewTicker(targetsPollInterval)
+	defer ticker.Stop()
+	for {
+		force := false
+		select {
+		case <-ctx.Done():
+			return
+		case <-hup:
+			force = true
+		case <-ticker.C:
+		}
+
+		changed := make(map[string]bool)
+		for name, last := range modified {
+			if mt := modTime(name); force || !mt.Equal(last) {
+				modified[name] = mt
+				changed[name] = true
+			}
+		}
+		for _, t := range tasks {
+			if changed[t.job.Targets] && t.ctx.Err() == nil {
+				if err := t.reloadTargets(); err != nil {
+					fmt.Fprintf(os.Stderr, "Failed to reload %s: %v\n", t.job.Targets, err)
+				} else {
+					fmt.Fprintf(os.Stderr, "Reloaded %s\n", t.job.Targets)
+				}
+			}
+		}
+	}
+}
+
+// taskSlice is the time a worker spends on one of several tasks
+// before it switches to the next one.
+const taskSlice = time.Second
+
+// maxWorkerSearches is the maximum number of searches a worker keeps paused between turns.
+// Every search holds batch buffers of its backend, so a worker of many tasks
+// stops the least recently run search and later starts the task over from a new offset.
+const maxWorkerSearches = 4
+
+func searchParallel(ctx context.Context, workers int, tasks []*searchTask, totalAttempts *atomic.Uint64) <-chan SearchResult {
 	results := make(chan SearchResult, workers)
 
+	gtx, cancel := context.WithCancel(ctx)
+	for _, t := range tasks {
+		t.ctx, t.cancel = context.WithCancel(gtx)
+		if t.job.Top > 0 {
+			t.top = make([]*topKeys, workers)
+			for w := range t.top {
+				t.top[w] = &topKeys{k: t.job.Top}
+			}
+		}
+	}
+
 	go func() {
 		defer close(results)
+		defer cancel()
 
-		var foundCount atomic.Uint64
 		var wg sync.WaitGroup
 
-		gtx, cancel := context.WithCancel(ctx)
-		defer cancel()
-
-		for range workers {
+		for w := range workers {
 			wg.Go(func() {
-				vanity25519.Search(gtx, startPublicKey, randBigInt(), 4096, test, func(publicKey []byte, offset *big.Int) {
-					r := SearchResult{
-						PublicKey: append([]byte(nil), publicKey...),
-						Offset:    new(big.Int).Set(offset),
-						Found:     true,
-					}
-					select {
-					case results <- r:
-					case <-gtx.Done():
-						return
-					}
-
-					if foundCount.Add(1) >= uint64(keysAmount) && keysAmount != 0 {
-						cancel()
-					}
-				})
+				runWorker(w, tasks, results, totalAttempts)
 			})
 		}
 		wg.Wait()
@@ -190,32 +624,189 @@ func searchParallel(ctx context.Context, workers int, startPublicKey []byte, tes
 	return results
 }
 
-func printParallel(results <-chan SearchResult, startKey *ecdh.PrivateKey, prefix string, start time.Time, totalAttempts *atomic.Uint64) bool {
+// runWorker rotates the worker over unfinished tasks until all are complete.
+// Workers start from different tasks so that tasks share workers evenly
+// and remaining tasks get all workers once others are complete.
+func runWorker(worker int, tasks []*searchTask, results chan<- SearchResult, totalAttempts *atomic.Uint64) {
+	// Paused searches, the least recently run first
+	var paused []*workerSearch
+	stop := func(s *workerSearch) {
+		s.cancel()
+		for s.run() {
+		}
+	}
+	defer func() {
+		for _, s := range paused {
+			stop(s)
+		}
+	}()
+
+	next := worker % len(tasks)
+	for {
+		var t *searchTask
+		for i := 0; i < len(tasks) && t == nil; i++ {
+			if c := tasks[(next+i)%len(tasks)]; c.ctx.Err() == nil {
+				t, next = c, (next+i+1)%len(tasks)
+			}
+		}
+		if t == nil {
+			return
+		}
+
+		paused = slices.DeleteFunc(paused, func(s *workerSearch) bool {
+			if s.task.ctx.Err() != nil {
+				stop(s)
+				return true
+			}
+			return false
+		})
+		i := slices.IndexFunc(paused, func(s *workerSearch) bool { return s.task == t })
+		var s *workerSearch
+		if i >= 0 {
+			s = paused[i]
+			paused = slices.Delete(paused, i, i+1)
+		} else {
+			if len(paused) >= maxWorkerSearches {
+				stop(paused[0])
+				paused = paused[1:]
+			}
+			s = newWorkerSearch(t, worker, results, totalAttempts)
+		}
+		if s.run() {
+			paused = append(paused, s)
+		}
+	}
+}
+
+// workerSearch is a search of a task that a worker runs in turns of taskSlice.
+// The search runs from a single start offset and is paused between batches.
+type workerSearch struct {
+	task   *searchTask
+	cancel context.CancelFunc
+	turn   chan struct{}
+	paused chan bool
+}
+
+// newWorkerSearch returns search of the task that starts on the first turn.
+func newWorkerSearch(t *searchTask, worker int, results chan<- SearchResult, totalAttempts *atomic.Uint64) *workerSearch {
+	ctx, cancel := context.WithCancel(t.ctx)
+	s := &workerSearch{task: t, cancel: cancel, turn: make(chan struct{}), paused: make(chan bool)}
+	go func() {
+		defer func() { s.paused <- false }()
+		defer cancel()
+
+		<-s.turn
+		start := time.Now()
+		t.search(ctx, worker, results, totalAttempts, func() {
+			if time.Since(start) >= taskSlice {
+				s.paused <- true
+				<-s.turn
+				start = time.Now()
+			}
+		})
+	}()
+	return s
+}
+
+// run gives the turn to the search and reports whether the search paused rather than ended.
+func (s *workerSearch) run() bool {
+	s.turn <- struct{}{}
+	return <-s.paused
+}
+
+func printParallel(results <-chan SearchResult, tasks []*searchTask, output string, start time.Time, totalAttempts *atomic.Uint64) bool {
+	switch output {
+	case "offset":
+		var anyFound bool
+		for r := range results {
+			anyFound = true
+			fmt.Println(r.Offset)
+		}
+		// Best keys follow found keys and are marked with the number of matching bits
+		for _, t := range tasks {
+			for _, r := range mergeTopKeys(t.job.Top, t.top) {
+				anyFound = true
+				fmt.Println(r.Offset, "best", r.Score)
+			}
+		}
+		return anyFound
+	case "json":
+		found := make(map[*searchTask][]SearchResult)
+		for r := range results {
+			found[r.task] = append(found[r.task], r)
+		}
+		anyFound := len(found) > 0
+		enc := json.NewEncoder(os.Stdout)
+		for _, t := range tasks {
+			if t.matcher.Load().rank != nil {
+				slices.SortStableFunc(found[t], func(a, b SearchResult) int {
+					return cmp.Compare(a.Distance, b.Distance)
+				})
+			}
+			bundle := newResultBundle(t, found[t], time.Since(start))
+			if err := enc.Encode(bundle); err != nil {
+				panic(err)
+			}
+			anyFound = anyFound || len(bundle.Best) > 0
+		}
+		return anyFound
+	}
+
+	ranked := slices.ContainsFunc(tasks, func(t *searchTask) bool { return t.matcher.Load().rank != nil })
+
+	rateWidth := 0
+	if ranked {
+		rateWidth = 10
+	}
+
+	// Table output has a single task
+	t := tasks[0]
+	privateWidth := len(t.enc.private(make([]byte, t.keyType.privateSize)))
+	publicWidth := len(t.enc.public(make([]byte, 32)))
+
 	var anyFound bool
-	fmt.Printf("%-44s %-44s %-10s %-10s %s\n", "private", "public", "attempts", "duration", "attempts/s")
+	fmt.Printf("%-*s %-*s %-10s %-10s %s", privateWidth, "private", publicWidth, "public", "attempts", "duration", "attempts/s")
+	if ranked {
+		fmt.Print(" distance")
+	}
+	fmt.Println()
 
 	for r := range results {
 		anyFound = true
-		public := base64.StdEncoding.EncodeToString(r.PublicKey)
-		private := "-"
-		if startKey != nil {
-			if vanityPrivateKey, err := vanity25519.Add(startKey.Bytes(), r.Offset); err == nil {
-				private = base64.StdEncoding.EncodeToString(vanityPrivateKey)
-			}
-		}
+		public := r.public()
+		private := r.private()
 		attempts := totalAttempts.Load()
 
 		elapsed := time.Since(start)
-		fmt.Printf("%-44s %-44s %-10d %-10s %.0f\n",
-			private,
-			public,
+		fmt.Printf("%-*s %-*s %-10d %-10s %-*.0f",
+			privateWidth, private,
+			publicWidth, public,
 			attempts,
 			elapsed.Round(time.Second),
+			rateWidth,
 			float64(attempts)/elapsed.Seconds(),
 		)
+		if ranked {
+			fmt.Printf(" %d", r.Distance)
+		}
+		fmt.Println()
+	}
+
+	for _, t := range tasks {
+		best := mergeTopKeys(t.job.Top, t.top)
+		if len(best) == 0 {
+			continue
+		}
+		anyFound = true
+		fmt.Printf("\nBest keys:\n%-*s %-*s %s\n", privateWidth, "private", publicWidth, "public", "matching bits")
+		for _, r := range best {
+			fmt.Printf("%-*s %-*s %d\n", privateWidth, r.private(), publicWidth, r.public(), r.Score)
+		}
 	}
 
-	fmt.Printf("\nCompleted in %s\n", time.Since(start).Round(time.Second))
+	elapsed := time.Since(start)
+	attempts := totalAttempts.Load()
+	fmt.Printf("\nCompleted in %s, checked %d keys at %.0f keys/s\n", elapsed.Round(time.Second), attempts, float64(attempts)/elapsed.Seconds())
 	return anyFound
 }
 
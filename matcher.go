@@ -0,0 +1,257 @@
+package main
+
+import (
+	"encoding/binary"
+	"encoding/hex"
+	"fmt"
+	"math"
+	"math/bits"
+	"os"
+	"strings"
+
+	"github.com/AlexanderYastrebov/vanity25519"
+)
+
+// matcher tests public keys against the job pattern.
+type matcher struct {
+	test func([]byte) bool
+	// score returns the number of leading bits of public key that match the pattern, may be nil.
+	score func([]byte) int
+	// rank returns distance of public key from the literal pattern spelling, may be nil.
+	rank func([]byte) int
+	// probability that random public key matches the pattern, zero if unknown.
+	probability float64
+	// speedup of approximate match over the literal pattern, zero if not applicable.
+	speedup float64
+	// quotas of the target set, nil for other patterns.
+	quotas *targetQuotas
+}
+
+func newMatcher(job Job) (*matcher, error) {
+	m, err := compileMatcher(job)
+	if err == nil && generatedPattern != "" && generatedPattern == patternKey(job) {
+		fmt.Fprintf(os.Stderr, "Using generated matcher\n")
+		m.test = generatedMatch
+	}
+	return m, err
+}
+
+func compileMatcher(job Job) (*matcher, error) {
+	if err := checkPatternOptions(job); err != nil {
+		return nil, err
+	}
+	m, err := compilePattern(job)
+	if err == nil && job.Top > 0 && m.score == nil {
+		return nil, fmt.Errorf("top is supported for prefix and mask patterns only")
+	}
+	return m, err
+}
+
+// checkPatternOptions returns error if the job sets several patterns
+// or options that do not apply to its pattern.
+func checkPatternOptions(job Job) error {
+	var patterns []string
+	for _, p := range []struct{ name, value string }{
+		{"prefix", job.Prefix},
+		{"regex", job.Regex},
+		{"expr", job.Expr},
+		{"mask", job.Mask},
+		{"targets", job.Targets},
+	} {
+		if p.value != "" {
+			patterns = append(patterns, p.name)
+		}
+	}
+	if len(patterns) > 1 {
+		return fmt.Errorf("%s can not be combined", strings.Join(patterns, " and "))
+	}
+
+	var unsupported []string
+	option := func(set bool, name string) {
+		if set {
+			unsupported = append(unsupported, name)
+		}
+	}
+	switch {
+	case job.Mask != "":
+		option(job.IgnoreCase, "ignore-case")
+		option(job.Homoglyphs, "homoglyphs")
+		option(job.MaxMismatch > 0, "max-mismatch")
+		option(job.Encoding != "" && job.Encoding != base64Encoding.name, "encoding")
+	case job.Targets != "":
+		option(job.IgnoreCase, "ignore-case")
+		option(job.Homoglyphs, "homoglyphs")
+		option(job.MaxMismatch > 0, "max-mismatch")
+	case job.Regex != "", job.Expr != "":
+		option(job.Homoglyphs, "homoglyphs")
+		option(job.MaxMismatch > 0, "max-mismatch")
+	}
+	if len(unsupported) > 0 {
+		return fmt.Errorf("%s does not support %s", patterns[0], strings.Join(unsupported, ", "))
+	}
+	return nil
+}
+
+// compilePattern returns matcher of the job pattern.
+func compilePattern(job Job) (*matcher, error) {
+	switch {
+	case job.Mask != "":
+		return newMaskMatcher(job.Mask)
+	case job.Encoding != "" && job.Encoding != base64Encoding.name:
+		e, err := keyEncodingByName(job.Encoding)
+		if err != nil {
+			return nil, err
+		}
+		return newEncodedMatcher(job, e)
+	case job.Targets != "":
+		return newTargetMatcher(job.Targets)
+	case job.Expr != "":
+		test, p, err := compileExpr(job.Expr, base64Encoding, job.IgnoreCase)
+		return &matcher{test: test, probability: p}, err
+	case job.Regex != "":
+		expr := job.Regex
+		if job.IgnoreCase {
+			expr = "(?i)" + expr
+		}
+		d, err := compileBase64Regex(expr)
+		if err != nil {
+			return nil, err
+		}
+		return &matcher{test: d.match}, nil
+	}
+
+	literal, err := parseBase64Glob(job.Prefix, job.IgnoreCase)
+	if err != nil {
+		return nil, err
+	}
+	sets := literal
+	if job.Homoglyphs {
+		sets = expandHomoglyphs(literal)
+	}
+
+	m := &matcher{
+		score:       newGlobScore(sets, base64Encoding),
+		probability: mismatchProbability(sets, job.MaxMismatch),
+	}
+	switch {
+	case job.MaxMismatch > 0:
+		m.test = newMismatchTest(sets, job.MaxMismatch)
+	case job.IgnoreCase || job.Homoglyphs || isGlob(job.Prefix):
+		m.test, err = newGlobTest(sets, base64Encoding)
+	default:
+		prefix, prefixBits := decodeBase64PrefixBits(job.Prefix)
+		m.test = vanity25519.HasPrefixBits(prefix, prefixBits)
+		m.score = newPrefixScore(prefix, prefixBits)
+	}
+	if job.Homoglyphs || job.MaxMismatch > 0 {
+		m.rank = func(pub []byte) int {
+			return globDistance(pub, literal)
+		}
+		m.speedup = m.probability / globProbability(literal, base64Encoding)
+	}
+	return m, err
+}
+
+// newEncodedMatcher returns matcher of prefix pattern or expression in encodings other than base64.
+func newEncodedMatcher(job Job, e *keyEncoding) (*matcher, error) {
+	if job.Targets != "" || job.Regex != "" || job.Homoglyphs || job.MaxMismatch > 0 {
+		return nil, fmt.Errorf("%s encoding supports prefix patterns and expressions only", e.name)
+	}
+	if job.Expr != "" {
+		test, p, err := compileExpr(job.Expr, e, job.IgnoreCase)
+		return &matcher{test: test, probability: p}, err
+	}
+	if job.Prefix == "" {
+		return nil, fmt.Errorf("prefix required for %s encoding", e.name)
+	}
+	sets, err := parseGlob(job.Prefix, e, job.IgnoreCase)
+	if err != nil {
+		return nil, err
+	}
+	test, err := newGlobTest(sets, e)
+	if err != nil {
+		return nil, err
+	}
+	return &matcher{
+		test:        test,
+		score:       newGlobScore(sets, e),
+		probability: globProbability(sets, e),
+	}, nil
+}
+
+// newTargetMatcher returns matcher of public keys that start with any target from the named file.
+func newTargetMatcher(name string) (*matcher, error) {
+	s, quotas, err := loadTargets(name)
+	if err != nil {
+		return nil, fmt.Errorf("%s: %w", name, err)
+	}
+	return s.matcher(newTargetQuotas(s, quotas)), nil
+}
+
+// newMaskMatcher returns matcher of raw public key bytes given as "<hex value>/<hex mask>".
+// Mask defaults to all bits of the value.
+func newMaskMatcher(s string) (*matcher, error) {
+	m, err := parseMask(s)
+	if err != nil {
+		return nil, err
+	}
+
+	maskBits := 0
+	for _, mk := range m.mask {
+		maskBits += bits.OnesCount64(mk)
+	}
+	return &matcher{
+		test:        newMaskedTest(m),
+		score:       newMaskScore(m),
+		probability: math.Pow(2, -float64(maskBits)),
+	}, nil
+}
+
+// parseMask returns masked bits of "<hex value>/<hex mask>".
+func parseMask(s string) (maskedBits, error) {
+	var m maskedBits
+	valueHex, maskHex, hasMask := strings.Cut(s, "/")
+	value, err := hex.DecodeString(valueHex)
+	if err != nil {
+		return m, fmt.Errorf("invalid mask value: %w", err)
+	}
+	mask := []byte(strings.Repeat("\xff", len(value)))
+	if hasMask {
+		if mask, err = hex.DecodeString(maskHex); err != nil {
+			return m, fmt.Errorf("invalid mask: %w", err)
+		}
+	}
+	if len(value) > 32 || len(mask) > 32 {
+		return m, fmt.Errorf("mask %q is longer than public key", s)
+	}
+
+	for i := 0; i < max(len(value), len(mask)); i++ {
+		var v, mk byte
+		if i < len(value) {
+			v = value[i]
+		}
+		if i < len(mask) {
+			mk = mask[i]
+		}
+		shift := 56 - 8*(i%8)
+		m.mask[i/8] |= uint64(mk) << shift
+		m.value[i/8] |= uint64(v&mk) << shift
+	}
+	return m, nil
+}
+
+// newMaskScore returns a function that counts mask bits of public key
+// that match before the first mismatch.
+func newMaskScore(m maskedBits) func([]byte) int {
+	return func(pub []byte) int {
+		score := 0
+		for w := range m.mask {
+			key := binary.BigEndian.Uint64(pub[8*w:])
+			if d := (key ^ m.value[w]) & m.mask[w]; d != 0 {
+				return score + bits.OnesCount64(m.mask[w]>>(64-bits.LeadingZeros64(d)))
+			}
+			score += bits.OnesCount64(m.mask[w])
+		}
+		return score
+	}
+}
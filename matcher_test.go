@@ -0,0 +1,34 @@
+package main
+
+import "testing"
+
+func TestCompileMatcherOptions(t *testing.T) {
+	for _, tc := range []struct {
+		job Job
+		ok  bool
+	}{
+		{Job{Prefix: "AY/"}, true},
+		{Job{Prefix: "AY/", IgnoreCase: true, Top: 3}, true},
+		{Job{Prefix: "AY/", Regex: "^AB"}, false},
+		{Job{Expr: "prefix(AB)", Mask: "0a/ff"}, false},
+		{Job{Regex: "^AB", IgnoreCase: true}, true},
+		{Job{Regex: "^AB", Homoglyphs: true}, false},
+		{Job{Regex: "^AB", MaxMismatch: 1}, false},
+		{Job{Regex: "^AB", Top: 3}, false},
+		{Job{Expr: "prefix(AB)", IgnoreCase: true}, true},
+		{Job{Expr: "prefix(AB)", Homoglyphs: true}, false},
+		{Job{Expr: "prefix(AB)", Top: 3}, false},
+		{Job{Mask: "0a/ff", Top: 3}, true},
+		{Job{Mask: "0a/ff", IgnoreCase: true}, false},
+		{Job{Mask: "0a/ff", Encoding: "hex"}, false},
+		{Job{Targets: "targets.txt", IgnoreCase: true}, false},
+		{Job{Targets: "targets.txt", MaxMismatch: 1}, false},
+	} {
+		_, err := compileMatcher(tc.job)
+		if tc.ok && err != nil {
+			t.Errorf("%+v: %v", tc.job, err)
+		} else if !tc.ok && err == nil {
+			t.Errorf("%+v: expected error", tc.job)
+		}
+	}
+}
@@ -0,0 +1,95 @@
+package main
+
+import (
+	"encoding/binary"
+	"math/bits"
+)
+
+const (
+	// symbolWordBits is the number of bits of ten base64 symbols packed into a 64-bit word.
+	symbolWordBits = 60
+
+	// symbolLowBits has the lowest bit of every symbol of the word set.
+	symbolLowBits = 0x0410410410410410
+)
+
+// newMismatchTest returns a function that tests whether at most maxMismatch
+// symbols of base64-encoded public key prefix do not match symbol sets.
+//
+// The public key is loaded as words of ten symbols and symbols of sets covered by a single cube,
+// i.e. a symbol, "?" or a class like "[A-P]", are counted by popcount without encoding.
+// Other sets, like case-insensitive letters or homoglyphs, are tested symbol by symbol.
+func newMismatchTest(sets []uint64, maxMismatch int) func([]byte) bool {
+	var value, mask [5]uint64
+	words := 0
+	var classes []int
+	for pos, set := range sets {
+		cubes := symbolCubes(set)
+		if len(cubes) != 1 {
+			classes = append(classes, pos)
+			continue
+		}
+		if cubes[0].mask == 0 {
+			continue
+		}
+		w, shift := pos/10, 58-6*(pos%10)
+		value[w] |= uint64(cubes[0].value) << shift
+		mask[w] |= uint64(cubes[0].mask) << shift
+		words = w + 1
+	}
+
+	return func(pub []byte) bool {
+		mismatch := 0
+		for w := range words {
+			d := (symbolWord(pub, w) ^ value[w]) & mask[w]
+			// Fold every symbol onto its lowest bit
+			d |= d >> 1
+			d |= d >> 2
+			d |= d >> 2
+			if mismatch += bits.OnesCount64(d & symbolLowBits); mismatch > maxMismatch {
+				return false
+			}
+		}
+		for _, pos := range classes {
+			if sets[pos]&(1<<base64Symbol(pub, pos)) == 0 {
+				if mismatch++; mismatch > maxMismatch {
+					return false
+				}
+			}
+		}
+		return true
+	}
+}
+
+// symbolWord returns ten base64 symbols of public key starting from symbol 10*w
+// in the upper 60 bits of the word.
+func symbolWord(pub []byte, w int) uint64 {
+	bit := symbolWordBits * w
+	if w == 4 {
+		// Only the last three symbols remain in the last two bytes.
+		return uint64(pub[30])<<56 | uint64(pub[31])<<48
+	}
+	return binary.BigEndian.Uint64(pub[bit/8:]) << (bit % 8) &^ 0xf
+}
+
+// mismatchProbability returns the probability that random public key matches
+// symbol sets with at most maxMismatch mismatching symbols.
+func mismatchProbability(sets []uint64, maxMismatch int) float64 {
+	// p[j] is the probability of exactly j mismatches
+	p := make([]float64, maxMismatch+1)
+	p[0] = 1
+	for _, set := range sets {
+		match := float64(bits.OnesCount64(set)) / 64
+		for j := maxMismatch; j >= 0; j-- {
+			p[j] *= match
+			if j > 0 {
+				p[j] += p[j-1] * (1 - match)
+			}
+		}
+	}
+	var sum float64
+	for _, pj := range p {
+		sum += pj
+	}
+	return sum
+}
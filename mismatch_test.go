@@ -0,0 +1,43 @@
+package main
+
+import (
+	"encoding/base64"
+	"strings"
+	"testing"
+)
+
+func TestMismatchTest(t *testing.T) {
+	for _, tc := range []struct {
+		pattern     string
+		ignoreCase  bool
+		maxMismatch int
+		hint        string
+	}{
+		{"ABCDEF", false, 1, "ABCDEx"},
+		{"ABCDEF", false, 2, "ABxDEx"},
+		{"AB?[A-P]EFGHIJKLMN", false, 3, "ABxCEFGHIJxxMN"},
+		{"????????????????????????????????????????ABQ", false, 1, "........................................AxQ"},
+		{"??????????????????????????????????????????B", false, 0, ""},
+		{"0123456789abcdefghijklmnopqrstuvwxyzABCDEFG", false, 30, "0123456789abcdefghijklmn"},
+		{"vpnGateway", true, 2, "VPNgatEwxy"},
+		{"[AO0][!A]x[0-9+]", false, 1, "0Bx+"},
+	} {
+		sets, err := parseBase64Glob(tc.pattern, tc.ignoreCase)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.pattern, err)
+		}
+		test := newMismatchTest(sets, tc.maxMismatch)
+		for _, pub := range randomKeys(20000, tc.hint) {
+			s := base64.StdEncoding.EncodeToString(pub)
+			mismatch := 0
+			for i, set := range sets {
+				if set&(1<<strings.IndexByte(base64Alphabet, s[i])) == 0 {
+					mismatch++
+				}
+			}
+			if got, want := test(pub), mismatch <= tc.maxMismatch; got != want {
+				t.Fatalf("%q: test(%s) = %t, want %t with %d mismatches", tc.pattern, s, got, want, mismatch)
+			}
+		}
+	}
+}
@@ -0,0 +1,14 @@
+//go:build !unix
+
+package main
+
+import "os"
+
+// mapFile reads the named file on platforms without mmap support.
+func mapFile(name string) ([]byte, error) {
+	return os.ReadFile(name)
+}
+
+func unmapFile(data []byte) error {
+	return nil
+}
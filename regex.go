@@ -0,0 +1,345 @@
+package main
+
+import (
+	"fmt"
+	"regexp/syntax"
+	"slices"
+	"strconv"
+	"strings"
+	"unicode"
+)
+
+const (
+	// base64Alphabet lists base64 symbols in the order of their 6-bit values.
+	base64Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+
+	// padSymbol is the value of the trailing '=' of base64-encoded public key.
+	padSymbol = 64
+
+	// dfaSymbols is the DFA input alphabet size: 64 base64 symbols and padding.
+	dfaSymbols = 65
+
+	// maxDFAStates limits the DFA size to keep transition table cache-resident.
+	maxDFAStates = 4096
+)
+
+const (
+	dfaDead   = -1
+	dfaAccept = -2
+)
+
+// base64DFA matches base64-encoded public key against a regular expression
+// without encoding it.
+// Symbols are extracted from public key bytes and fed to the DFA
+// which stops as soon as the match is decided.
+type base64DFA struct {
+	// next holds transitions indexed by state*dfaSymbols+symbol.
+	// Negative values denote dead and accepting states.
+	next []int32
+	// acceptAtEnd reports states that accept at the end of input, i.e. via $.
+	acceptAtEnd []bool
+	start       int32
+}
+
+// compileBase64Regex compiles regular expression into DFA over base64 symbols.
+// Like regexp.MatchString, unanchored expression matches anywhere in the encoded public key.
+func compileBase64Regex(expr string) (*base64DFA, error) {
+	re, err := syntax.Parse(expr, syntax.Perl)
+	if err != nil {
+		return nil, err
+	}
+
+	n := &nfa{}
+	match := n.add(nfaNode{op: nfaMatch})
+	start, err := n.compile(re.Simplify(), match)
+	if err != nil {
+		return nil, fmt.Errorf("regex %q: %w", expr, err)
+	}
+	return n.determinize(start)
+}
+
+func (d *base64DFA) match(pub []byte) bool {
+	s := d.start
+	if s < 0 {
+		return s == dfaAccept
+	}
+	i := 0
+	for ; i+3 <= len(pub); i += 3 {
+		v := uint32(pub[i])<<16 | uint32(pub[i+1])<<8 | uint32(pub[i+2])
+		if s = d.next[s*dfaSymbols+int32(v>>18)]; s < 0 {
+			return s == dfaAccept
+		}
+		if s = d.next[s*dfaSymbols+int32(v>>12&63)]; s < 0 {
+			return s == dfaAccept
+		}
+		if s = d.next[s*dfaSymbols+int32(v>>6&63)]; s < 0 {
+			return s == dfaAccept
+		}
+		if s = d.next[s*dfaSymbols+int32(v&63)]; s < 0 {
+			return s == dfaAccept
+		}
+	}
+	// Public key is 32 bytes long so the last quantum has two bytes:
+	// three symbols followed by padding.
+	v := uint32(pub[i])<<16 | uint32(pub[i+1])<<8
+	if s = d.next[s*dfaSymbols+int32(v>>18)]; s < 0 {
+		return s == dfaAccept
+	}
+	if s = d.next[s*dfaSymbols+int32(v>>12&63)]; s < 0 {
+		return s == dfaAccept
+	}
+	if s = d.next[s*dfaSymbols+int32(v>>6&63)]; s < 0 {
+		return s == dfaAccept
+	}
+	if s = d.next[s*dfaSymbols+padSymbol]; s < 0 {
+		return s == dfaAccept
+	}
+	return d.acceptAtEnd[s]
+}
+
+type nfaOp uint8
+
+const (
+	nfaSymbols nfaOp = iota // consumes a symbol from the set
+	nfaSplit                // epsilon transitions to out and out1
+	nfaBegin                // epsilon transition to out at the beginning of input
+	nfaEnd                  // epsilon transition to out at the end of input
+	nfaMatch
+)
+
+// symbolSet is a set of DFA input symbols.
+type symbolSet [2]uint64
+
+func (s *symbolSet) add(sym int)                { s[sym/64] |= 1 << (sym % 64) }
+func (s symbolSet) has(sym int) bool            { return s[sym/64]&(1<<(sym%64)) != 0 }
+func (s symbolSet) union(o symbolSet) symbolSet { return symbolSet{s[0] | o[0], s[1] | o[1]} }
+
+var allSymbols = symbolSet{^uint64(0), 1}
+
+type nfaNode struct {
+	op   nfaOp
+	set  symbolSet
+	out  int
+	out1 int
+}
+
+type nfa struct {
+	nodes []nfaNode
+}
+
+func (n *nfa) add(node nfaNode) int {
+	n.nodes = append(n.nodes, node)
+	return len(n.nodes) - 1
+}
+
+// compile adds nodes matching re followed by next and returns the entry node.
+func (n *nfa) compile(re *syntax.Regexp, next int) (int, error) {
+	switch re.Op {
+	case syntax.OpNoMatch:
+		return n.add(nfaNode{op: nfaSymbols}), nil
+	case syntax.OpEmptyMatch:
+		return next, nil
+	case syntax.OpLiteral:
+		for i := len(re.Rune) - 1; i >= 0; i-- {
+			set := runeSymbols(re.Rune[i], re.Flags&syntax.FoldCase != 0)
+			next = n.add(nfaNode{op: nfaSymbols, set: set, out: next})
+		}
+		return next, nil
+	case syntax.OpCharClass:
+		var set symbolSet
+		for i := 0; i+1 < len(re.Rune); i += 2 {
+			set = set.union(rangeSymbols(re.Rune[i], re.Rune[i+1]))
+		}
+		return n.add(nfaNode{op: nfaSymbols, set: set, out: next}), nil
+	case syntax.OpAnyChar, syntax.OpAnyCharNotNL:
+		return n.add(nfaNode{op: nfaSymbols, set: allSymbols, out: next}), nil
+	case syntax.OpBeginLine, syntax.OpBeginText:
+		return n.add(nfaNode{op: nfaBegin, out: next}), nil
+	case syntax.OpEndLine, syntax.OpEndText:
+		return n.add(nfaNode{op: nfaEnd, out: next}), nil
+	case syntax.OpCapture:
+		return n.compile(re.Sub[0], next)
+	case syntax.OpStar:
+		split := n.add(nfaNode{op: nfaSplit, out1: next})
+		entry, err := n.compile(re.Sub[0], split)
+		n.nodes[split].out = entry
+		return split, err
+	case syntax.OpPlus:
+		split := n.add(nfaNode{op: nfaSplit, out1: next})
+		entry, err := n.compile(re.Sub[0], split)
+		n.nodes[split].out = entry
+		return entry, err
+	case syntax.OpQuest:
+		entry, err := n.compile(re.Sub[0], next)
+		return n.add(nfaNode{op: nfaSplit, out: entry, out1: next}), err
+	case syntax.OpConcat:
+		for i := len(re.Sub) - 1; i >= 0; i-- {
+			var err error
+			if next, err = n.compile(re.Sub[i], next); err != nil {
+				return 0, err
+			}
+		}
+		return next, nil
+	case syntax.OpAlternate:
+		entry, err := n.compile(re.Sub[len(re.Sub)-1], next)
+		for i := len(re.Sub) - 2; i >= 0 && err == nil; i-- {
+			var alt int
+			alt, err = n.compile(re.Sub[i], next)
+			entry = n.add(nfaNode{op: nfaSplit, out: alt, out1: entry})
+		}
+		return entry, err
+	}
+	return 0, fmt.Errorf("unsupported %s", re)
+}
+
+// closure follows epsilon transitions from the node and collects
+// symbol and end-of-input nodes into set.
+// It reports whether match node is reachable.
+func (n *nfa) closure(node int, atBegin, atEnd bool, set map[int]bool) bool {
+	if set[node] {
+		return false
+	}
+	nd := &n.nodes[node]
+	switch nd.op {
+	case nfaSymbols:
+		set[node] = true
+		return false
+	case nfaSplit:
+		set[node] = true
+		m := n.closure(nd.out, atBegin, atEnd, set)
+		return n.closure(nd.out1, atBegin, atEnd, set) || m
+	case nfaBegin:
+		if atBegin {
+			set[node] = true
+			return n.closure(nd.out, atBegin, atEnd, set)
+		}
+		return false
+	case nfaEnd:
+		set[node] = true
+		if atEnd {
+			return n.closure(nd.out, atBegin, atEnd, set)
+		}
+		return false
+	case nfaMatch:
+		return true
+	}
+	return false
+}
+
+// dfaState is a set of NFA symbol and end-of-input nodes.
+type dfaState []int
+
+func (s dfaState) key() string {
+	var b strings.Builder
+	for _, node := range s {
+		b.WriteString(strconv.Itoa(node))
+		b.WriteByte(',')
+	}
+	return b.String()
+}
+
+// stateOf returns DFA state reachable from NFA nodes
+// and reports whether match node is reachable.
+func (n *nfa) stateOf(nodes []int, atBegin bool) (dfaState, bool) {
+	set := make(map[int]bool)
+	matched := false
+	for _, node := range nodes {
+		if n.closure(node, atBegin, false, set) {
+			matched = true
+		}
+	}
+	var s dfaState
+	for node := range set {
+		if op := n.nodes[node].op; op == nfaSymbols || op == nfaEnd {
+			s = append(s, node)
+		}
+	}
+	slices.Sort(s)
+	return s, matched
+}
+
+// determinize builds DFA using subset construction.
+// Every state also includes the start node to match anywhere in the input.
+func (n *nfa) determinize(start int) (*base64DFA, error) {
+	d := &base64DFA{}
+	index := make(map[string]int32)
+	var states []dfaState
+
+	stateIndex := func(s dfaState, matched bool) (int32, error) {
+		if matched {
+			return dfaAccept, nil
+		}
+		if len(s) == 0 {
+			return dfaDead, nil
+		}
+		k := s.key()
+		if i, ok := index[k]; ok {
+			return i, nil
+		}
+		if len(states) == maxDFAStates {
+			return 0, fmt.Errorf("regex is too complex: more than %d DFA states", maxDFAStates)
+		}
+		i := int32(len(states))
+		index[k] = i
+		states = append(states, s)
+		return i, nil
+	}
+
+	var err error
+	if d.start, err = stateIndex(n.stateOf([]int{start}, true)); err != nil {
+		return nil, err
+	}
+
+	for i := 0; i < len(states); i++ {
+		s := states[i]
+
+		set := make(map[int]bool)
+		acceptAtEnd := false
+		for _, node := range s {
+			if n.closure(node, false, true, set) {
+				acceptAtEnd = true
+			}
+		}
+		d.acceptAtEnd = append(d.acceptAtEnd, acceptAtEnd)
+
+		for sym := 0; sym < dfaSymbols; sym++ {
+			nodes := []int{start}
+			for _, node := range s {
+				if nd := n.nodes[node]; nd.op == nfaSymbols && nd.set.has(sym) {
+					nodes = append(nodes, nd.out)
+				}
+			}
+			next, err := stateIndex(n.stateOf(nodes, false))
+			if err != nil {
+				return nil, err
+			}
+			d.next = append(d.next, next)
+		}
+	}
+	return d, nil
+}
+
+// runeSymbols returns set of symbols matching rune r.
+func runeSymbols(r rune, foldCase bool) symbolSet {
+	set := rangeSymbols(r, r)
+	if foldCase {
+		for f := unicode.SimpleFold(r); f != r; f = unicode.SimpleFold(f) {
+			set = set.union(rangeSymbols(f, f))
+		}
+	}
+	return set
+}
+
+// rangeSymbols returns set of symbols within [lo, hi] rune range.
+func rangeSymbols(lo, hi rune) symbolSet {
+	var set symbolSet
+	for sym, c := range base64Alphabet {
+		if lo <= c && c <= hi {
+			set.add(sym)
+		}
+	}
+	if lo <= '=' && '=' <= hi {
+		set.add(padSymbol)
+	}
+	return set
+}
@@ -0,0 +1,63 @@
+package main
+
+import (
+	"encoding/base64"
+	"math/rand"
+	"regexp"
+	"testing"
+)
+
+// randomKeys returns n pseudo-random public keys, every other key is encoded with the symbols of hint
+// except "." so that patterns match often enough to compare.
+func randomKeys(n int, hint string) [][]byte {
+	r := rand.New(rand.NewSource(1))
+	keys := make([][]byte, n)
+	for i := range keys {
+		pub := make([]byte, 32)
+		r.Read(pub)
+		if i%2 == 0 {
+			s := []byte(base64.StdEncoding.EncodeToString(pub))
+			for j := 0; j < len(hint); j++ {
+				if hint[j] != '.' {
+					s[j] = hint[j]
+				}
+			}
+			pub, _ = base64.StdEncoding.DecodeString(string(s))
+		}
+		keys[i] = pub
+	}
+	return keys
+}
+
+func TestBase64Regex(t *testing.T) {
+	for _, tc := range []struct {
+		expr string
+		hint string
+	}{
+		{`^AB`, "AB"},
+		{`^(vpn|gw)[0-9]{2}`, "vpn1"},
+		{`^[A-Z]{4}/`, "ABC"},
+		{`Q=$`, "..........................................Q"},
+		{`[0-9]{3}`, "..12"},
+		{`(?i)^ab`, "aB"},
+		{`^A*B`, "AAB"},
+		{`^.{42}[AQgw]=$`, ""},
+		{`A.B$`, "........................................A"},
+		{`^[a-c]+[0-9]?x`, "ab1"},
+		{`ab|^c|d$`, "c"},
+		{`=`, ""},
+		{``, ""},
+	} {
+		d, err := compileBase64Regex(tc.expr)
+		if err != nil {
+			t.Fatalf("%q: %v", tc.expr, err)
+		}
+		re := regexp.MustCompile(tc.expr)
+		for _, pub := range randomKeys(20000, tc.hint) {
+			s := base64.StdEncoding.EncodeToString(pub)
+			if got, want := d.match(pub), re.MatchString(s); got != want {
+				t.Fatalf("%q: match(%s) = %t, want %t", tc.expr, s, got, want)
+			}
+		}
+	}
+}
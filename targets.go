@@ -0,0 +1,360 @@
+package main
+
+import (
+	"bufio"
+	"bytes"
+	"encoding/binary"
+	"fmt"
+	"io"
+	"math"
+	"math/bits"
+	"os"
+	"runtime"
+	"slices"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+)
+
+const (
+	// targetsMagic starts the sorted target table built by the index subcommand.
+	targetsMagic = "WVKTGT1\n"
+
+	// maxTargetSymbols is the maximum target length, ten symbols fit into a 64-bit record.
+	maxTargetSymbols = 10
+
+	// targetFilterBits is the number of filter bits per target.
+	// Sixteen bits keep the false positive rate below 0.1%
+	// and the filter of a million targets within 2 MiB.
+	targetFilterBits = 16
+)
+
+// targetRecord returns the sorted table record of a literal base64 prefix:
+// prefix bits aligned to the most significant bit and the number of symbols in the lowest four bits.
+func targetRecord(prefix string) (uint64, error) {
+	if len(prefix) == 0 || len(prefix) > maxTargetSymbols {
+		return 0, fmt.Errorf("target %q must have 1 to %d symbols", prefix, maxTargetSymbols)
+	}
+	var r uint64
+	for i := 0; i < len(prefix); i++ {
+		v := strings.IndexByte(base64Alphabet, prefix[i])
+		if v < 0 {
+			return 0, fmt.Errorf("invalid symbol %q in target %q", prefix[i], prefix)
+		}
+		r |= uint64(v) << (58 - 6*i)
+	}
+	return r | uint64(len(prefix)), nil
+}
+
+// parseTargets parses targets, one per line, optionally followed by the quota:
+// the number of keys to find for the target. Either all or none of the targets have quotas.
+// It returns the sorted table and quotas by target record, nil if there are none.
+// Empty lines and lines starting with "#" are ignored.
+// Targets longer than maxTargetSymbols are skipped with a warning:
+// a 10-symbol prefix already takes 2^60 attempts on average, so longer ones are practically never found.
+func parseTargets(r io.Reader) ([]byte, map[uint64]int, error) {
+	var records []uint64
+	var quotas map[uint64]int
+	var skipped, unlimited int
+	sc := bufio.NewScanner(r)
+	for sc.Scan() {
+		fields := strings.Fields(sc.Text())
+		if len(fields) == 0 || fields[0][0] == '#' {
+			continue
+		}
+		if len(fields) > 2 {
+			return nil, nil, fmt.Errorf("invalid target line %q", sc.Text())
+		}
+		if len(fields[0]) > maxTargetSymbols {
+			skipped++
+			continue
+		}
+		rec, err := targetRecord(fields[0])
+		if err != nil {
+			return nil, nil, err
+		}
+		records = append(records, rec)
+		if len(fields) == 1 {
+			unlimited++
+		} else {
+			quota, err := strconv.Atoi(fields[1])
+			if err != nil || quota <= 0 {
+				return nil, nil, fmt.Errorf("invalid quota %q of target %q", fields[1], fields[0])
+			}
+			if quotas == nil {
+				quotas = make(map[uint64]int)
+			}
+			quotas[rec] += quota
+		}
+	}
+	if err := sc.Err(); err != nil {
+		return nil, nil, err
+	}
+	if quotas != nil && unlimited > 0 {
+		// Targets without quota would never be retired and the search would never end
+		return nil, nil, fmt.Errorf("%d targets have no quota, either all or none of the targets must have quotas", unlimited)
+	}
+	if skipped > 0 {
+		fmt.Fprintf(os.Stderr, "Skipped %d targets longer than %d symbols\n", skipped, maxTargetSymbols)
+	}
+	slices.Sort(records)
+	return encodeTargetTable(slices.Compact(records)), quotas, nil
+}
+
+// encodeTargetTable returns the table of sorted target records.
+func encodeTargetTable(records []uint64) []byte {
+	table := make([]byte, 0, len(targetsMagic)+8*len(records))
+	table = append(table, targetsMagic...)
+	for _, rec := range records {
+		table = binary.LittleEndian.AppendUint64(table, rec)
+	}
+	return table
+}
+
+// loadTargets returns the target set and quotas from the named file.
+// A table built by the index subcommand is mapped into memory,
+// otherwise the file is parsed as a list of targets.
+func loadTargets(name string) (*targetSet, map[uint64]int, error) {
+	data, err := mapFile(name)
+	if err != nil {
+		return nil, nil, err
+	}
+	if !bytes.HasPrefix(data, []byte(targetsMagic)) {
+		defer unmapFile(data)
+		table, quotas, err := parseTargets(bytes.NewReader(data))
+		if err != nil {
+			return nil, nil, err
+		}
+		s, err := newTargetSet(table)
+		return s, quotas, err
+	}
+
+	s, err := newTargetSet(data)
+	if err != nil {
+		unmapFile(data)
+		return nil, nil, err
+	}
+	// The set is the only user of the mapping. Workers drop it
+	// when they pick up a matcher of the reloaded or reduced target set.
+	runtime.SetFinalizer(s, func(*targetSet) { unmapFile(data) })
+	return s, nil, nil
+}
+
+// targetSet matches public keys against a large set of literal prefixes.
+// A blocked Bloom filter over the leading bits shared by all targets
+// rejects most candidates with a single cache line access,
+// the rest are looked up in the sorted table.
+type targetSet struct {
+	// records holds sorted little-endian targetRecord values.
+	records []byte
+	// blocks is the Bloom filter, each block occupies a single cache line.
+	blocks [][8]uint64
+	// shift extracts the filter key from the leading public key bits.
+	shift uint
+	// lengths is the set of target lengths.
+	lengths uint16
+	// probability that random public key matches any target.
+	probability float64
+}
+
+func newTargetSet(table []byte) (*targetSet, error) {
+	records := table[len(targetsMagic):]
+	n := len(records) / 8
+	if len(records)%8 != 0 {
+		return nil, fmt.Errorf("invalid target table size %d", len(table))
+	}
+	if n == 0 {
+		return nil, fmt.Errorf("no targets")
+	}
+
+	s := &targetSet{
+		records: records,
+		blocks:  make([][8]uint64, (n*targetFilterBits+511)/512),
+	}
+	minSymbols := maxTargetSymbols
+	for i := range n {
+		rec := s.record(i)
+		if i > 0 && rec <= s.record(i-1) {
+			return nil, fmt.Errorf("target table is not sorted")
+		}
+		symbols := int(rec & 15)
+		if symbols == 0 || symbols > maxTargetSymbols {
+			return nil, fmt.Errorf("invalid target record %x", rec)
+		}
+		minSymbols = min(minSymbols, symbols)
+		s.lengths |= 1 << symbols
+		s.probability += math.Ldexp(1, -6*symbols)
+	}
+	s.shift = uint(64 - 6*minSymbols)
+	for i := range n {
+		block, h := s.hash(s.record(i) >> s.shift)
+		b := &s.blocks[block]
+		for w := range b {
+			b[w] |= 1 << (h >> (6 * w) & 63)
+		}
+	}
+	return s, nil
+}
+
+func (s *targetSet) record(i int) uint64 {
+	return binary.LittleEndian.Uint64(s.records[8*i:])
+}
+
+// hash returns the filter block of the key and the hash that selects a bit in every block word.
+func (s *targetSet) hash(key uint64) (uint64, uint64) {
+	h := key * 0x9e3779b97f4a7c15
+	block := (h >> 32) * uint64(len(s.blocks)) >> 32
+	h ^= h >> 29
+	h *= 0xbf58476d1ce4e5b9
+	return block, h
+}
+
+func (s *targetSet) match(pub []byte) bool {
+	key := binary.BigEndian.Uint64(pub)
+	block, h := s.hash(key >> s.shift)
+	b := &s.blocks[block]
+	for w := range b {
+		if b[w]&(1<<(h>>(6*w)&63)) == 0 {
+			return false
+		}
+	}
+	_, ok := s.lookup(key)
+	return ok
+}
+
+// lookup returns the shortest target record that is a prefix of the leading public key bits.
+func (s *targetSet) lookup(key uint64) (uint64, bool) {
+	n := len(s.records) / 8
+	for lengths := s.lengths; lengths != 0; lengths &= lengths - 1 {
+		symbols := bits.TrailingZeros16(lengths)
+		want := key&^(1<<(64-6*symbols)-1) | uint64(symbols)
+		i := sort.Search(n, func(i int) bool { return s.record(i) >= want })
+		if i < n && s.record(i) == want {
+			return want, true
+		}
+	}
+	return 0, false
+}
+
+func (s *targetSet) matcher(quotas *targetQuotas) *matcher {
+	return &matcher{test: s.match, probability: s.probability, quotas: quotas}
+}
+
+// targetQuotas tracks the number of keys still wanted for each target.
+// Targets that met their quota are retired from the target set.
+type targetQuotas struct {
+	mu        sync.Mutex
+	set       *targetSet
+	remaining map[uint64]int
+	// claimed counts keys found for targets with quota, it carries over to reloaded quotas.
+	claimed map[uint64]int
+	// next replaces these quotas after the target list is reloaded.
+	next *targetQuotas
+}
+
+func newTargetQuotas(set *targetSet, quotas map[uint64]int) *targetQuotas {
+	if quotas == nil {
+		quotas = make(map[uint64]int)
+	}
+	return &targetQuotas{set: set, remaining: quotas, claimed: make(map[uint64]int)}
+}
+
+// limited reports whether any target has a quota.
+func (q *targetQuotas) limited() bool {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+	return len(q.remaining) > 0
+}
+
+// claim reports whether found public key counts towards the quota of a live target.
+// When the target meets its quota, claim calls update under lock
+// with the matcher of remaining targets so that updates are ordered.
+// It reports done when all targets have been retired.
+func (q *targetQuotas) claim(pub []byte, update func(*matcher)) (ok, done bool) {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	if q.next != nil {
+		return q.next.claim(pub, update)
+	}
+	if q.set == nil {
+		return false, true
+	}
+	rec, ok := q.set.lookup(binary.BigEndian.Uint64(pub))
+	if !ok {
+		// Found by a worker that did not pick up the updated matcher yet
+		return false, false
+	}
+	quota, limited := q.remaining[rec]
+	if !limited {
+		return true, false
+	}
+	q.claimed[rec]++
+	if quota > 1 {
+		q.remaining[rec] = quota - 1
+		return true, false
+	}
+	return true, q.retire(update, rec)
+}
+
+// replace carries claimed keys over to the quotas of the reloaded target list,
+// calls update with its matcher and forwards further claims to it.
+// It reports done when all targets of the reloaded list have met their quotas.
+func (q *targetQuotas) replace(next *targetQuotas, update func(*matcher)) (done bool) {
+	q.mu.Lock()
+	defer q.mu.Unlock()
+
+	if q.next != nil {
+		return q.next.replace(next, update)
+	}
+	next.mu.Lock()
+	defer next.mu.Unlock()
+
+	var retired []uint64
+	for rec, n := range q.claimed {
+		next.claimed[rec] += n
+		if quota, ok := next.remaining[rec]; ok {
+			if quota > n {
+				next.remaining[rec] = quota - n
+			} else {
+				retired = append(retired, rec)
+			}
+		}
+	}
+	q.next = next
+	if len(retired) == 0 {
+		update(next.set.matcher(next))
+		return false
+	}
+	return next.retire(update, retired...)
+}
+
+// retire removes targets from the target set and calls update with the matcher of remaining targets.
+// It reports whether no targets remain.
+func (q *targetQuotas) retire(update func(*matcher), retired ...uint64) bool {
+	drop := make(map[uint64]bool, len(retired))
+	for _, rec := range retired {
+		delete(q.remaining, rec)
+		drop[rec] = true
+	}
+
+	n := len(q.set.records) / 8
+	records := make([]uint64, 0, n)
+	for i := range n {
+		if r := q.set.record(i); !drop[r] {
+			records = append(records, r)
+		}
+	}
+	if len(records) == 0 {
+		q.set = nil
+		return true
+	}
+	set, err := newTargetSet(encodeTargetTable(records))
+	if err != nil {
+		panic(err)
+	}
+	q.set = set
+	update(set.matcher(q))
+	return false
+}
@@ -0,0 +1,87 @@
+package main
+
+import (
+	"context"
+	"encoding/base64"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+func TestTargetSet(t *testing.T) {
+	r := rand.New(rand.NewSource(1))
+	targets := make(map[string]bool)
+	var list []string
+	var sb strings.Builder
+	for len(targets) < 50000 {
+		b := make([]byte, 3+r.Intn(maxTargetSymbols-2))
+		for i := range b {
+			b[i] = base64Alphabet[r.Intn(64)]
+		}
+		if !targets[string(b)] {
+			targets[string(b)] = true
+			list = append(list, string(b))
+			sb.WriteString(string(b) + "\n")
+		}
+	}
+	table, _, err := parseTargets(strings.NewReader(sb.String()))
+	if err != nil {
+		t.Fatal(err)
+	}
+	s, err := newTargetSet(table)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	hits := 0
+	for i, pub := range randomKeys(200000, "") {
+		if i%2 == 0 {
+			// Start every other key with a target
+			enc := []byte(base64.StdEncoding.EncodeToString(pub))
+			copy(enc, list[r.Intn(len(list))])
+			pub, _ = base64.StdEncoding.DecodeString(string(enc))
+		}
+		enc := base64.StdEncoding.EncodeToString(pub)
+		want := false
+		for n := 1; n <= maxTargetSymbols; n++ {
+			want = want || targets[enc[:n]]
+		}
+		if got := s.match(pub); got != want {
+			t.Fatalf("match(%s) = %t, want %t", enc, got, want)
+		}
+		if want {
+			hits++
+		}
+	}
+	if hits < 100000 {
+		t.Errorf("got %d hits, want at least 100000", hits)
+	}
+}
+
+func TestTargetQuotas(t *testing.T) {
+	name := filepath.Join(t.TempDir(), "targets.txt")
+	if err := os.WriteFile(name, []byte("A 2\nB 1\n"), 0o644); err != nil {
+		t.Fatal(err)
+	}
+	task := newSearchTask(Job{Targets: name, BatchSize: 256, Keys: 1})
+
+	ctx, cancel := context.WithTimeout(context.Background(), time.Minute)
+	defer cancel()
+
+	// The search ends once both targets are retired
+	var attempts atomic.Uint64
+	found := make(map[byte]int)
+	for r := range searchParallel(ctx, 2, []*searchTask{task}, &attempts) {
+		found[base64.StdEncoding.EncodeToString(r.PublicKey)[0]]++
+	}
+	if ctx.Err() != nil {
+		t.Fatal("search did not end after quotas were met")
+	}
+	if found['A'] != 2 || found['B'] != 1 || len(found) != 2 {
+		t.Errorf("found %v, want 2 keys starting with A and 1 with B", found)
+	}
+}
@@ -0,0 +1,84 @@
+package main
+
+import (
+	"cmp"
+	"container/heap"
+	"math/bits"
+	"slices"
+)
+
+// topKeys keeps k found public keys with the highest score.
+// Each worker has its own topKeys so that it does not need locking.
+type topKeys struct {
+	k       int
+	results resultHeap
+}
+
+// threshold returns the minimal score a public key needs to get into the top.
+func (t *topKeys) threshold() int {
+	if len(t.results) < t.k {
+		return 0
+	}
+	return t.results[0].Score + 1
+}
+
+func (t *topKeys) push(r SearchResult) {
+	heap.Push(&t.results, r)
+	if len(t.results) > t.k {
+		heap.Pop(&t.results)
+	}
+}
+
+// mergeTopKeys returns k results with the highest score sorted by descending score.
+func mergeTopKeys(k int, tops []*topKeys) []SearchResult {
+	var all []SearchResult
+	for _, t := range tops {
+		if t != nil {
+			all = append(all, t.results...)
+		}
+	}
+	slices.SortStableFunc(all, func(a, b SearchResult) int {
+		return cmp.Compare(b.Score, a.Score)
+	})
+	return all[:min(k, len(all))]
+}
+
+// resultHeap is a min-heap of results by score.
+type resultHeap []SearchResult
+
+func (h resultHeap) Len() int           { return len(h) }
+func (h resultHeap) Less(i, j int) bool { return h[i].Score < h[j].Score }
+func (h resultHeap) Swap(i, j int)      { h[i], h[j] = h[j], h[i] }
+func (h *resultHeap) Push(x any)        { *h = append(*h, x.(SearchResult)) }
+func (h *resultHeap) Pop() any {
+	old := *h
+	r := old[len(old)-1]
+	*h = old[:len(old)-1]
+	return r
+}
+
+// newPrefixScore returns a function that counts leading bits of public key
+// that match decoded prefix bits.
+func newPrefixScore(prefix []byte, prefixBits int) func([]byte) int {
+	return func(pub []byte) int {
+		for i := range prefix {
+			if x := pub[i] ^ prefix[i]; x != 0 {
+				return min(8*i+bits.LeadingZeros8(x), prefixBits)
+			}
+		}
+		return prefixBits
+	}
+}
+
+// newGlobScore returns a function that counts leading bits of public key
+// that match symbol sets, each matching symbol counts as the number of bits it encodes.
+func newGlobScore(sets []uint64, e *keyEncoding) func([]byte) int {
+	return func(pub []byte) int {
+		for pos, set := range sets {
+			if set&(1<<e.symbol(pub, pos)) == 0 {
+				return e.bits * pos
+			}
+		}
+		return e.bits * len(sets)
+	}
+}